@@ -0,0 +1,503 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+using namespace std;
+
+// separate chaining shared by many threads:
+//  - writers take one of NUM_LOCKS striped spinlocks (by hash), so writers on different stripes run in parallel
+//  - readers take no lock at all; bucket heads and next pointers are atomics published with release stores
+//  - removed nodes are not freed until every reader that might still be looking at them has left
+//    (epoch based reclamation)
+//  - resize copies the chains into a bucket array twice the size one stripe at a time and tags each
+//    old head it has moved, so only the writers of that stripe wait; readers and writers that find a
+//    tagged head continue in the new array, and readers already on an old chain finish walking it
+
+const int NUM_LOCKS = 64;       // power of two; the bucket count is always a multiple of it
+const int MAX_THREADS = 256;    // threads that may use tables at the same time
+const double MAX_LOAD = 1.0;    // keys per bucket before the bucket array doubles
+const int RECLAIM_EVERY = 64;   // retired objects per thread between attempts to free some
+
+// ---- thread slots ----
+// every thread using a table gets a small id, returned when the thread exits
+atomic<bool> slot_taken[MAX_THREADS];
+
+struct thread_slot {
+    int id = -1;
+    thread_slot() {
+        for (int i = 0; i < MAX_THREADS; i++) {
+            bool expected = false;
+            if (!slot_taken[i].load(memory_order_relaxed) && slot_taken[i].compare_exchange_strong(expected, true)) {
+                id = i;
+                return;
+            }
+        }
+        cerr << "more than " << MAX_THREADS << " threads" << endl;
+        abort();
+    }
+    ~thread_slot() {
+        slot_taken[id].store(false);
+    }
+};
+
+int thread_index() {
+    thread_local thread_slot slot;
+    return slot.id;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// ---- epoch based reclamation ----
+// a reader announces the global epoch while it works and IDLE otherwise. the global epoch only
+// moves from e to e + 1 once every active reader has announced e, so an object unlinked and retired
+// in epoch e cannot be reachable by anyone once the global epoch reaches e + 2
+class epochs {
+    static constexpr uint64_t IDLE = ~0ULL;
+
+    struct retired {
+        void* ptr;
+        void (*free)(void*);
+        uint64_t epoch;
+    };
+    struct alignas(64) participant {
+        atomic<uint64_t> announced{IDLE};
+        deque<retired> limbo; // oldest first; only touched by the thread owning this slot
+    };
+
+    atomic<uint64_t> global{0};
+    participant slots[MAX_THREADS];
+
+    bool try_advance() {
+        uint64_t e = global.load();
+        atomic_thread_fence(memory_order_seq_cst);
+        for (auto& p : slots) {
+            uint64_t a = p.announced.load(memory_order_acquire); // sees the exit of readers that left
+            if (a != IDLE && a != e) return false;
+        }
+        return global.compare_exchange_strong(e, e + 1);
+    }
+
+    void reclaim(participant& p) {
+        try_advance();
+        uint64_t safe = global.load();
+        while (!p.limbo.empty() && p.limbo.front().epoch + 2 <= safe) {
+            p.limbo.front().free(p.limbo.front().ptr);
+            p.limbo.pop_front();
+        }
+    }
+
+public:
+    ~epochs() {
+        for (auto& p : slots) {
+            for (auto& r : p.limbo) r.free(r.ptr);
+        }
+    }
+
+    void enter() {
+        participant& p = slots[thread_index()];
+        p.announced.store(global.load(memory_order_relaxed), memory_order_relaxed);
+        // pairs with the fence in try_advance: either the advancer sees this announcement, or this
+        // thread sees every unlink that happened before the epoch moved on
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+    void exit() {
+        slots[thread_index()].announced.store(IDLE, memory_order_release);
+    }
+
+    // ptr is already unreachable for new readers; free(ptr) runs once old readers are gone
+    void retire(void* ptr, void (*free)(void*)) {
+        participant& p = slots[thread_index()];
+        p.limbo.push_back({ptr, free, global.load()});
+        if (p.limbo.size() % RECLAIM_EVERY == 0) reclaim(p);
+    }
+
+    // frees everything this thread retired that no reader can still reach; for quiet moments
+    void collect() {
+        participant& p = slots[thread_index()];
+        reclaim(p);
+        reclaim(p);
+    }
+};
+
+// enter on construction, exit on destruction
+struct epoch_guard {
+    epochs& e;
+    epoch_guard(epochs& owner) : e(owner) { e.enter(); }
+    ~epoch_guard() { e.exit(); }
+};
+
+class ConcurrentSeparateChaining {
+    struct node {
+        int key;
+        atomic<node*> next;
+        node(int k, node* n) : key(k), next(n) {}
+    };
+
+    // a head with the low bit set belongs to a bucket already copied into `next`; the untagged
+    // pointer is the old chain, which the copier has retired
+    static bool moved(node* n) { return (uintptr_t)n & 1; }
+    static node* tagged(node* n) { return (node*)((uintptr_t)n | 1); }
+
+    struct buckets {
+        size_t size; // power of two, multiple of NUM_LOCKS
+        atomic<node*>* heads;
+        atomic<buckets*> next{nullptr}; // the array twice the size, once resize starts on this one
+        atomic<bool> growing{false};    // claimed by the one thread that resizes this array
+        buckets(size_t s) : size(s), heads(new atomic<node*>[s]) {
+            for (size_t i = 0; i < s; i++) heads[i].store(nullptr, memory_order_relaxed);
+        }
+        ~buckets() { delete[] heads; }
+        void clear() {
+            for (size_t i = 0; i < size; i++) {
+                node* n = heads[i].load(memory_order_relaxed);
+                if (!moved(n)) free_chain(n);
+            }
+        }
+    };
+
+    // one lock and one key counter per stripe, each on its own cache line
+    struct alignas(64) stripe {
+        atomic<bool> locked{false};
+        size_t count = 0; // keys whose hash falls in this stripe; changed under the lock
+
+        void lock() {
+            for (int spins = 0; locked.exchange(true, memory_order_acquire); spins++) {
+                while (locked.load(memory_order_relaxed)) {
+                    // more threads than cores: let the holder run instead of burning its time slice
+                    if (++spins > 64) this_thread::yield();
+                    else cpu_relax();
+                }
+            }
+        }
+        void unlock() { locked.store(false, memory_order_release); }
+    };
+
+    atomic<buckets*> table;
+    stripe stripes[NUM_LOCKS];
+    epochs reclaimer;
+
+    static void free_node(void* p) { delete static_cast<node*>(p); }
+    static void free_chain(void* p) {
+        node* n = static_cast<node*>(p);
+        while (n) {
+            node* next = n->next.load(memory_order_relaxed);
+            delete n;
+            n = next;
+        }
+    }
+    // a bucket array goes with the chains it still holds; a resized one holds none
+    static void free_buckets(void* p) {
+        buckets* b = static_cast<buckets*>(p);
+        b->clear();
+        delete b;
+    }
+
+    // spreads the bits so masking with a power of two uses all of them
+    static uint64_t mix(int key) {
+        uint64_t h = (uint32_t)key;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // the head of h's bucket in the array that holds it now. the caller holds h's stripe, so the
+    // bucket cannot be moved meanwhile
+    static atomic<node*>& bucket(buckets* t, uint64_t h) {
+        while (moved(t->heads[h & (t->size - 1)].load(memory_order_relaxed))) t = t->next.load(memory_order_relaxed);
+        return t->heads[h & (t->size - 1)];
+    }
+
+    // doubles t; only the thread that set t->growing gets here, and only it retires t, so no epoch
+    // is held and the old chains can be freed while the copy goes on. one stripe at a time: bucket
+    // i of t splits into i and i + size of the new array, both in the same stripe, so writers wait
+    // only for their own stripe's share of the keys. the nodes are copied rather than relinked, and
+    // a reader already on an old chain finishes it intact
+    void resize(buckets* t) {
+        buckets* grown = new buckets(t->size * 2);
+        t->next.store(grown, memory_order_release);
+        vector<node*> old;
+        for (int k = 0; k < NUM_LOCKS; k++) {
+            stripes[k].lock();
+            for (size_t i = k; i < t->size; i += NUM_LOCKS) {
+                node* chain = t->heads[i].load(memory_order_relaxed);
+                for (node* n = chain; n; n = n->next.load(memory_order_relaxed)) {
+                    atomic<node*>& head = grown->heads[hashfunction(n->key) & (grown->size - 1)];
+                    head.store(new node(n->key, head.load(memory_order_relaxed)), memory_order_relaxed);
+                }
+                // the release publishes both new buckets together with the tag
+                t->heads[i].store(tagged(chain), memory_order_release);
+                if (chain) old.push_back(chain);
+            }
+            stripes[k].unlock();
+            for (node* chain : old) reclaimer.retire(chain, free_chain);
+            old.clear();
+        }
+        table.store(grown, memory_order_release);
+        reclaimer.retire(t, free_buckets);
+    }
+
+public:
+    ConcurrentSeparateChaining(size_t s = NUM_LOCKS) {
+        size_t size = NUM_LOCKS;
+        while (size < s) size *= 2;
+        table.store(new buckets(size));
+    }
+
+    ~ConcurrentSeparateChaining() {
+        free_buckets(table.load());
+    }
+
+    ConcurrentSeparateChaining(const ConcurrentSeparateChaining&) = delete;
+    ConcurrentSeparateChaining& operator=(const ConcurrentSeparateChaining&) = delete;
+
+    uint64_t hashfunction(int key) {
+        return mix(key);
+    }
+
+    // lock free; safe to call while other threads insert, delete and resize
+    bool search(int key) {
+        epoch_guard guard(reclaimer);
+        buckets* t = table.load(memory_order_acquire);
+        uint64_t h = hashfunction(key);
+        node* n = t->heads[h & (t->size - 1)].load(memory_order_acquire);
+        while (moved(n)) {
+            t = t->next.load(memory_order_acquire);
+            n = t->heads[h & (t->size - 1)].load(memory_order_acquire);
+        }
+        for (; n; n = n->next.load(memory_order_acquire)) {
+            if (n->key == key) return true;
+        }
+        return false;
+    }
+
+    // false if the key was already there
+    bool insert(int key) {
+        uint64_t h = hashfunction(key);
+        stripe& s = stripes[h & (NUM_LOCKS - 1)];
+        buckets* grow = nullptr;
+        {
+            epoch_guard guard(reclaimer);
+            s.lock();
+            buckets* t = table.load(memory_order_acquire);
+            atomic<node*>& head = bucket(t, h);
+            for (node* n = head.load(memory_order_relaxed); n; n = n->next.load(memory_order_relaxed)) {
+                if (n->key == key) {
+                    s.unlock();
+                    return false;
+                }
+            }
+            head.store(new node(key, head.load(memory_order_relaxed)), memory_order_release);
+            s.count++;
+            // this stripe's share stands in for the whole table, so no global counter is contended.
+            // t is still alive under the guard; after it, only the thread that claimed it may touch it
+            if (s.count * NUM_LOCKS > t->size * MAX_LOAD && !t->growing.exchange(true)) grow = t;
+            s.unlock();
+        }
+        if (grow) resize(grow);
+        return true;
+    }
+
+    // false if the key was not there
+    bool deletekey(int key) {
+        uint64_t h = hashfunction(key);
+        stripe& s = stripes[h & (NUM_LOCKS - 1)];
+        epoch_guard guard(reclaimer);
+        s.lock();
+        atomic<node*>* link = &bucket(table.load(memory_order_acquire), h);
+        for (node* n = link->load(memory_order_relaxed); n; link = &n->next, n = link->load(memory_order_relaxed)) {
+            if (n->key == key) {
+                // readers standing on n still see its next pointer, which is left untouched
+                link->store(n->next.load(memory_order_relaxed), memory_order_release);
+                s.count--;
+                s.unlock();
+                reclaimer.retire(n, free_node);
+                return true;
+            }
+        }
+        s.unlock();
+        return false;
+    }
+
+    // the keys of bucket i of t, followed into the new array if resize has moved it
+    static void chainkeys(buckets* t, size_t i, vector<int>& keys) {
+        node* n = t->heads[i].load(memory_order_acquire);
+        if (moved(n)) {
+            buckets* grown = t->next.load(memory_order_acquire);
+            chainkeys(grown, i, keys);
+            chainkeys(grown, i + t->size, keys);
+            return;
+        }
+        for (; n; n = n->next.load(memory_order_acquire)) keys.push_back(n->key);
+    }
+
+    // a snapshot; concurrent writers may or may not show up in it
+    void printtable() {
+        epoch_guard guard(reclaimer);
+        buckets* t = table.load(memory_order_acquire);
+        vector<int> keys;
+        for (size_t i = 0; i < t->size; i++) {
+            keys.clear();
+            chainkeys(t, i, keys);
+            if (keys.empty()) continue;
+            cout << i << " : ";
+            for (int k : keys) cout << k << " -> ";
+            cout << "NULL" << endl;
+        }
+    }
+
+    // frees old nodes and bucket arrays this thread left behind, e.g. after a bulk load that resized
+    // many times. otherwise they go a few at a time with later deletes
+    void collect() {
+        reclaimer.collect();
+    }
+
+    size_t bucketcount() {
+        return table.load(memory_order_acquire)->size;
+    }
+};
+
+// what the service does today: one table behind one mutex
+class GlobalLockTable {
+    unordered_set<int> keys;
+    mutex lock;
+
+public:
+    bool search(int key) {
+        lock_guard<mutex> guard(lock);
+        return keys.count(key);
+    }
+    bool insert(int key) {
+        lock_guard<mutex> guard(lock);
+        return keys.insert(key).second;
+    }
+    bool deletekey(int key) {
+        lock_guard<mutex> guard(lock);
+        return keys.erase(key);
+    }
+    void collect() {} // nothing is deferred
+};
+
+// every thread inserts and deletes its own keys (key % threads == thread) and checks each result
+// against a private std::set, while everyone searches everywhere. a block of keys inserted up front
+// is never deleted and must be found by every search, through all the resizes
+bool stresstest(int threads, int opsperthread) {
+    ConcurrentSeparateChaining h(NUM_LOCKS);
+    const int STABLE = 10000;
+    for (int k = 0; k < STABLE; k++) h.insert(-1 - k);
+    vector<set<int>> expected(threads);
+    atomic<bool> ok{true};
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            mt19937 rng(t);
+            set<int>& mine = expected[t];
+            for (int i = 0; i < opsperthread && ok; i++) {
+                int key = (int)(rng() % 200000) / threads * threads + t;
+                int op = rng() % 10;
+                if (op < 4) {
+                    if (h.insert(key) != mine.insert(key).second) ok = false;
+                } else if (op < 7) {
+                    if (h.deletekey(key) != (mine.erase(key) == 1)) ok = false;
+                } else if (op < 9) {
+                    if (h.search(key) != (mine.count(key) == 1)) ok = false;
+                } else {
+                    if (!h.search(-1 - (int)(rng() % STABLE))) ok = false;
+                }
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    for (int t = 0; t < threads && ok; t++) {
+        for (int key : expected[t]) {
+            if (!h.search(key)) ok = false;
+        }
+    }
+    cout << "stress test, " << threads << " threads x " << opsperthread << " ops, grew to " << h.bucketcount()
+         << " buckets: " << (ok ? "passed" : "FAILED") << endl;
+    return ok;
+}
+
+// 90% search, 5% insert, 5% delete over a prefilled key range; million operations per second.
+// keys are scattered (i * odd constant) so std's identity hash gets no locality our mixer lacks
+template <class Table>
+double throughput(int threads, int opsperthread) {
+    const int RANGE = 1 << 20;
+    auto keyof = [](unsigned i) { return (int)(i * 2654435761u); };
+    Table h;
+    for (int i = 0; i < RANGE; i += 2) h.insert(keyof(i));
+    h.collect(); // the bulk load's old bucket arrays are not part of the measurement
+    atomic<int> ready{0};
+    atomic<bool> go{false};
+    atomic<long> hits{0}; // keeps the searches from being optimized away
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            mt19937 rng(t + 1);
+            ready++;
+            while (!go) this_thread::yield();
+            long found = 0;
+            for (int i = 0; i < opsperthread; i++) {
+                int key = keyof(rng() % RANGE);
+                int op = rng() % 20;
+                if (op == 0) h.insert(key);
+                else if (op == 1) h.deletekey(key);
+                else found += h.search(key);
+            }
+            hits += found;
+        });
+    }
+    while (ready < threads) this_thread::yield();
+    auto start = chrono::steady_clock::now();
+    go = true;
+    for (auto& th : pool) th.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return threads * (double)opsperthread / seconds / 1e6;
+}
+
+int main() {
+    ConcurrentSeparateChaining h;
+
+    // Hardcoded keys
+    int values[] = {50, 21, 58, 17, 28, 35, 10, 5, 99, 100};
+
+    cout << "Inserting keys...\n";
+    for (int k : values) h.insert(k);
+    h.printtable();
+
+    cout << "\nSearching keys...\n";
+    cout << "21: " << (h.search(21) ? "found" : "not found") << endl;
+    cout << "42: " << (h.search(42) ? "found" : "not found") << endl;
+
+    cout << "\nDeleting keys...\n";
+    cout << "28: " << (h.deletekey(28) ? "deleted" : "not found") << endl;
+    cout << "99: " << (h.deletekey(99) ? "deleted" : "not found") << endl;
+    cout << "99 again: " << (h.deletekey(99) ? "deleted" : "not found") << endl;
+
+    cout << endl;
+    if (!stresstest(8, 200000) || !stresstest(32, 20000)) return 1;
+
+    cout << "\nthroughput, 90% search / 5% insert / 5% delete, " << thread::hardware_concurrency() << " hardware threads\n";
+    cout << "threads   striped + lock-free reads   global mutex   (Mops/s)\n";
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        int ops = 2000000 / threads;
+        double ours = throughput<ConcurrentSeparateChaining>(threads, ops);
+        double global = throughput<GlobalLockTable>(threads, ops);
+        cout << threads << "\t  " << ours << "\t\t\t      " << global << endl;
+    }
+    return 0;
+}
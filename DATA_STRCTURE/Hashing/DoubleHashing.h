@@ -0,0 +1,204 @@
+#pragma once
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "hash_stats.h"
+using namespace std;
+
+inline bool isprime(int n) {
+    if (n < 2) return false;
+    for (int j = 2; j * j <= n; j++) {
+        if (n % j == 0) return false;
+    }
+    return true;
+}
+
+class DoubleHashing {
+    // grow (or clean up) once keys plus deleted marks would fill more than this
+    static constexpr double MAX_LOAD = 0.7;
+    // old slots moved to the new array by every insert or remove while the table is rebuilt
+    static constexpr int MIGRATE_STEP = 16;
+
+    enum state : unsigned char { EMPTY, FULL, DELETED };
+
+    struct table {
+        vector<int> hashtable;
+        vector<state> slotstate; // so every int, -1 and -2 included, can be a key
+        int size = 0;
+        int prime = 3; // for secondary hash function
+        int count = 0;
+        int deleted = 0;
+
+        void init(int s) {
+            size = s;
+            count = deleted = 0;
+            hashtable.assign(size, 0);
+            slotstate.assign(size, EMPTY);
+            prime = getPrime();
+        }
+
+        // primary hash function, never negative
+        int hash1(int key) {
+            int index = key % size;
+            return index < 0 ? index + size : index;
+        }
+
+        // secondary hash function, in [1, prime]
+        int hash2(int key) {
+            int r = key % prime;
+            return prime - (r < 0 ? r + prime : r);
+        }
+
+        // helper function: find nearest smaller prime
+        int getPrime() {
+            for (int i = size - 1; i >= 2; i--) {
+                if (isprime(i)) return i;
+            }
+            return 3; // fallback
+        }
+
+        // i-th probe; the table size is prime, so every step visits every slot
+        int probe(int index, int step, int i) {
+            return (index + (long long)i * step) % size;
+        }
+
+        int find(int key) {
+            int index = hash1(key);
+            int step = hash2(key);
+            for (int i = 0; i < size; i++) {
+                int slot = probe(index, step, i);
+                HASH_PROBE();
+                if (slotstate[slot] == EMPTY) return -1;
+                if (slotstate[slot] == FULL && hashtable[slot] == key) return slot;
+            }
+            return -1;
+        }
+
+        // first slot of the sequence that is not FULL, reusing deleted ones
+        int place(int key) {
+            int index = hash1(key);
+            int step = hash2(key);
+            for (int i = 0; ; i++) {
+                int slot = probe(index, step, i);
+                HASH_PROBE();
+                if (slotstate[slot] != FULL) {
+                    if (slotstate[slot] == DELETED) deleted--;
+                    hashtable[slot] = key;
+                    slotstate[slot] = FULL;
+                    count++;
+                    return slot;
+                }
+            }
+        }
+    };
+
+    table cur;         // where inserts go
+    table old;         // the array being emptied while the table is rebuilt
+    int migrated = -1; // old slots below this are already in cur; -1 when not rebuilding
+
+    bool migrating() {
+        return migrated >= 0;
+    }
+
+    void migrate(int steps) {
+        HASH_PAUSE_PROBES();
+        for (int s = 0; s < steps && migrated < old.size; s++, migrated++) {
+            if (old.slotstate[migrated] == FULL) cur.place(old.hashtable[migrated]);
+        }
+        if (migrated == old.size) {
+            old = table();
+            migrated = -1;
+        }
+    }
+
+    // mostly deleted marks: rebuild at the same size to drop them. mostly keys: grow to the
+    // next prime past twice the size
+    void rebuild() {
+        if (migrating()) migrate(old.size); // only if a previous rebuild could not finish in time
+        int newsize = cur.size;
+        if (cur.count + 1 > cur.size * MAX_LOAD / 2) {
+            newsize = 2 * cur.size;
+            while (!isprime(newsize)) newsize++;
+        }
+        HASH_STATS_ONLY(stats.resize(cur.size, newsize);)
+        old = move(cur);
+        cur.init(newsize);
+        migrated = 0;
+    }
+
+    // slot of key in the old array if it still lives there, or -1
+    int findold(int key) {
+        if (!migrating()) return -1;
+        int i = old.find(key);
+        return i >= migrated ? i : -1;
+    }
+
+public:
+    // constructor; the size is rounded up to a prime so every step size reaches every slot
+    DoubleHashing(int s) {
+        while (!isprime(s)) s++;
+        cur.init(s);
+    }
+
+    // insert function
+    void insert(int key) {
+        HASH_COUNT_PROBES(OP_INSERT);
+        if (contains(key)) return;
+        if (cur.count + cur.deleted + 1 > cur.size * MAX_LOAD) rebuild();
+        cur.place(key);
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+    // search function
+    bool search(int key) {
+        HASH_COUNT_PROBES(OP_SEARCH);
+        return contains(key);
+    }
+
+    bool contains(int key) {
+        return cur.find(key) != -1 || findold(key) != -1;
+    }
+
+    // remove function
+    void remove(int key) {
+        HASH_COUNT_PROBES(OP_DELETE);
+        int slot = cur.find(key);
+        table* t = &cur;
+        if (slot == -1) {
+            slot = findold(key);
+            t = &old;
+        }
+        if (slot != -1) {
+            t->slotstate[slot] = DELETED; // mark deleted
+            t->count--;
+            t->deleted++;
+        }
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+#ifdef HASH_STATS
+    hash_stats stats;
+
+    // the counters plus a snapshot of the current array; chains are runs of full or deleted slots
+    hash_stats& statistics() {
+        stats.keys = cur.count;
+        stats.slots = cur.size;
+        stats.tombstones = cur.deleted;
+        stats.runs(cur.size, [&](int i) { return cur.slotstate[i] != EMPTY; });
+        return stats;
+    }
+#endif
+
+    // display function
+    void display() {
+        if (migrating()) migrate(old.size);
+        for (int i = 0; i < cur.size; i++) {
+            if (cur.slotstate[i] == FULL)
+                cout << i << " --> " << cur.hashtable[i] << endl;
+            else if (cur.slotstate[i] == EMPTY)
+                cout << i << " --> EMPTY" << endl;
+            else
+                cout << i << " --> DELETED" << endl;
+        }
+    }
+};
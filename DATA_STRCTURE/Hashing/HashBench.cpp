@@ -0,0 +1,203 @@
+// YCSB-style benchmark of the int tables in this folder:
+//   g++ -O2 -std=c++17 HashBench.cpp -o HashBench                 throughput and latency
+//   g++ -O2 -std=c++17 -DHASH_STATS HashBench.cpp -o HashBench    plus probe lengths, load, chains
+// usage: HashBench [records] [operations]
+#ifndef HASH_QUIET
+#define HASH_QUIET
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "DoubleHashing.h"
+#include "LinearProbing.h"
+#include "SeparateChaining.h"
+#include "SwissTable.h"
+#include "normal_hashing.h"
+#include "quadraticprobing.h"
+using namespace std;
+
+// every table starts this small, so the load phase grows it many times
+const int START_SIZE = 16;
+// one operation in this many is timed on its own
+const int SAMPLE = 8;
+// ids of keys that are never inserted start here; inserted ids stay far below
+const uint32_t MISS_BASE = 1u << 31;
+
+// ids 0, 1, 2 ... become keys spread over the whole int range by the murmur3 finalizer, a bijection,
+// so distinct ids stay distinct keys. sequential ids would sit in order under key % size and flatter
+// every table; so would a plain multiply, whose low bits depend only on the low bits of the id
+int key_of(uint32_t id) {
+    id ^= id >> 16;
+    id *= 0x85EBCA6Bu;
+    id ^= id >> 13;
+    id *= 0xC2B2AE35u;
+    id ^= id >> 16;
+    return (int)id;
+}
+
+// the YCSB zipfian generator (Gray et al., "Quickly generating billion-record synthetic databases"):
+// rank 0 is the most popular, rank i is drawn with probability proportional to 1 / (i + 1)^theta
+struct zipfian {
+    long long n;
+    double theta, alpha, zetan, eta;
+
+    static double zeta(long long n, double theta) {
+        double sum = 0;
+        for (long long i = 1; i <= n; i++) sum += 1 / pow((double)i, theta);
+        return sum;
+    }
+
+    zipfian(long long n, double theta = 0.99) : n(n), theta(theta) {
+        alpha = 1 / (1 - theta);
+        zetan = zeta(n, theta);
+        eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / zetan);
+    }
+
+    long long next(mt19937& rng) {
+        double u = uniform_real_distribution<double>(0, 1)(rng);
+        double uz = u * zetan;
+        if (uz < 1) return 0;
+        if (uz < 1 + pow(0.5, theta)) return 1;
+        long long r = (long long)(n * pow(eta * u - eta + 1, alpha));
+        return r < n ? r : n - 1;
+    }
+};
+
+enum op_type { READ, INSERT, DELETE };
+
+struct op {
+    op_type type;
+    int key;
+};
+
+struct workload {
+    const char* name;
+    int read, insert; // percent; the rest are deletes
+    int miss;         // percent of reads for keys that were never inserted
+};
+
+// the operation stream, built once per workload so every table replays exactly the same one.
+// the live keys are the ids in [lo, hi): inserts add id hi, deletes remove the oldest id lo,
+// and reads pick a rank from the distribution and count it from lo, so a read meant to hit always hits
+vector<op> trace(const workload& w, bool zipf, int records, int ops) {
+    mt19937 rng(7);
+    zipfian z(records);
+    uint32_t lo = 0, hi = records, miss = MISS_BASE;
+    vector<op> out(ops);
+    for (op& o : out) {
+        int r = rng() % 100;
+        if (r < w.read) {
+            if ((int)(rng() % 100) < w.miss) {
+                o = {READ, key_of(miss++)};
+            } else {
+                long long rank = zipf ? z.next(rng) : rng() % records;
+                o = {READ, key_of(lo + rank % (hi - lo))};
+            }
+        } else if (r < w.read + w.insert || hi - lo <= 1) {
+            o = {INSERT, key_of(hi++)};
+        } else {
+            o = {DELETE, key_of(lo++)};
+        }
+    }
+    return out;
+}
+
+// the tables differ in the name of delete only
+void erase(linearprobing& t, int key) { t.remove(key); }
+void erase(quadraticprobing& t, int key) { t.remove(key); }
+void erase(DoubleHashing& t, int key) { t.remove(key); }
+void erase(swisstable& t, int key) { t.remove(key); }
+void erase(SeparateChaining& t, int key) { t.deletekey(key); }
+void erase(NormalHashing& t, int key) { t.deleteKey(key); }
+
+double seconds_since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+template <class Table>
+bool apply(Table& t, const op& o) {
+    switch (o.type) {
+    case READ:
+        return t.search(o.key);
+    case INSERT:
+        t.insert(o.key);
+        break;
+    case DELETE:
+        erase(t, o.key);
+        break;
+    }
+    return false;
+}
+
+// load the records, then replay the trace: throughput over all of it, latency from every SAMPLE-th operation
+template <class Table>
+void run(const char* name, int records, const vector<op>& ops) {
+    Table t(START_SIZE);
+    auto start = chrono::steady_clock::now();
+    for (int id = 0; id < records; id++) t.insert(key_of(id));
+    double load = seconds_since(start);
+
+    vector<long long> latency;
+    latency.reserve(ops.size() / SAMPLE + 1);
+    long long reads = 0, hits = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < ops.size(); i++) {
+        bool hit;
+        if (i % SAMPLE == 0) {
+            auto t0 = chrono::steady_clock::now();
+            hit = apply(t, ops[i]);
+            latency.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count());
+        } else {
+            hit = apply(t, ops[i]);
+        }
+        reads += ops[i].type == READ;
+        hits += hit;
+    }
+    double total = seconds_since(start);
+
+    auto percentile = [&](double p) {
+        size_t k = min(latency.size() - 1, (size_t)(p * latency.size()));
+        nth_element(latency.begin(), latency.begin() + k, latency.end());
+        return latency[k];
+    };
+    cout << name << "\t" << records / load / 1e6 << "\t" << ops.size() / total / 1e6 << "\t" << percentile(0.5) << "\t"
+         << percentile(0.99) << "\t" << percentile(0.999) << "\t" << (reads ? 100.0 * hits / reads : 0) << endl;
+#ifdef HASH_STATS
+    t.statistics().print(cout);
+#endif
+}
+
+int main(int argc, char** argv) {
+    int records = argc > 1 ? atoi(argv[1]) : 100000;
+    int ops = argc > 2 ? atoi(argv[2]) : 1000000;
+
+    workload workloads[] = {
+        {"C: 100% read", 100, 0, 0},
+        {"C': 100% read, half of them misses", 100, 0, 50},
+        {"B: 95% read, 5% insert", 95, 5, 0},
+        {"A: 50% read, 25% insert, 25% delete", 50, 25, 0},
+    };
+    cout.setf(ios::fixed);
+    cout.precision(2);
+    for (const workload& w : workloads) {
+        for (bool zipf : {false, true}) {
+            vector<op> t = trace(w, zipf, records, ops);
+            cout << "\nworkload " << w.name << ", " << (zipf ? "zipfian" : "uniform") << " keys, " << records
+                 << " records, " << ops << " operations\n"
+                 << "(load, run: million operations per second; latency percentiles in ns)\n";
+            cout << "table\t\tload\trun\tp50\tp99\tp99.9\thit %" << endl;
+            run<NormalHashing>("normal\t", records, t);
+            run<linearprobing>("linear\t", records, t);
+            run<quadraticprobing>("quadratic", records, t);
+            run<DoubleHashing>("double\t", records, t);
+            run<SeparateChaining>("chaining", records, t);
+            run<swisstable>("swiss\t", records, t);
+        }
+    }
+    return 0;
+}
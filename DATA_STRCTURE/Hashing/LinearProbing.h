@@ -0,0 +1,217 @@
+#pragma once
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "hash_stats.h"
+using namespace std;
+
+// one contiguous array of slots, robin hood ordering, backward shift deletion.
+// growing allocates an array twice the size and moves the keys over a few slots per operation,
+// so no single insert pays for rehashing the whole table
+class linearprobing {
+    // grow once the table would be fuller than this
+    static constexpr double MAX_LOAD = 0.85;
+    // old slots moved to the new array by every insert or remove while the table grows
+    static constexpr int MIGRATE_STEP = 16;
+
+    struct slot {
+        int key;
+        int dist; // how far the key sits from its home index, -1 = empty
+    };
+
+    struct table {
+        vector<slot> slots;
+        int size = 0;
+        int count = 0; // keys stored
+
+        void init(int m) {
+            size = m;
+            count = 0;
+            slots.assign(size, {0, -1});
+        }
+
+        int next(int i) {
+            return i + 1 == size ? 0 : i + 1;
+        }
+
+        int home(int key) {
+            int index = key % size;
+            return index < 0 ? index + size : index;
+        }
+
+        // index of key, or -1. stops at an empty slot or at a key closer to its home than
+        // key would be here: robin hood would have put key in front of it
+        int find(int key) {
+            int i = home(key);
+            for (int dist = 0; dist <= slots[i].dist; dist++) {
+                HASH_PROBE();
+                if (slots[i].key == key) return i;
+                i = next(i);
+            }
+            HASH_PROBE(); // the slot that ended the search
+            return -1;
+        }
+
+        // walk from home; whenever the resident is closer to its home than the key we carry,
+        // the carried key takes the slot and the resident is carried on. returns where key landed
+        int place(int key) {
+            slot carry = {key, 0};
+            int i = home(key);
+            int placed = -1;
+            while (slots[i].dist != -1) {
+                HASH_PROBE();
+                if (slots[i].dist < carry.dist) {
+                    swap(carry, slots[i]);
+                    if (placed == -1) placed = i;
+                }
+                i = next(i);
+                carry.dist++;
+            }
+            HASH_PROBE();
+            slots[i] = carry;
+            count++;
+            return placed == -1 ? i : placed;
+        }
+
+        // pull the following keys one slot back toward their homes until one is already home
+        void erase(int i) {
+            int j = next(i);
+            while (slots[j].dist > 0) {
+                slots[i] = {slots[j].key, slots[j].dist - 1};
+                i = j;
+                j = next(j);
+            }
+            slots[i].dist = -1;
+            count--;
+        }
+    };
+
+    table cur;         // where inserts go
+    table old;         // the array being emptied while growing
+    vector<bool> gone; // old slots removed before they were migrated
+    int migrated = -1; // old slots below this are already in cur; -1 when not growing
+
+    bool migrating() {
+        return migrated >= 0;
+    }
+
+    // the old array is never modified while it drains (a backward shift could move an unmigrated
+    // key below the cursor), so removals there only set `gone`
+    void migrate(int steps) {
+        HASH_PAUSE_PROBES();
+        for (int s = 0; s < steps && migrated < old.size; s++, migrated++) {
+            if (old.slots[migrated].dist != -1 && !gone[migrated]) cur.place(old.slots[migrated].key);
+        }
+        if (migrated == old.size) {
+            old = table();
+            gone = vector<bool>();
+            migrated = -1;
+        }
+    }
+
+    void grow() {
+        if (migrating()) migrate(old.size); // only if a previous growth could not finish in time
+        HASH_LOG("table grows from " << cur.size << " to " << 2 * cur.size << " slots" << endl);
+        HASH_STATS_ONLY(stats.resize(cur.size, 2 * cur.size);)
+        old = move(cur);
+        cur.init(2 * old.size);
+        gone.assign(old.size, false);
+        migrated = 0;
+    }
+
+    // slot of key in the old array if it still lives there, or -1
+    int findold(int key) {
+        if (!migrating()) return -1;
+        int i = old.find(key);
+        return i >= migrated && !gone[i] ? i : -1;
+    }
+
+public:
+    // constructor
+    linearprobing(int m) {
+        cur.init(m);
+    }
+
+    // hash function, never negative
+    int hashfunction(int key) {
+        return cur.home(key);
+    }
+
+    // insert key
+    void insert(int key) {
+        HASH_COUNT_PROBES(OP_INSERT);
+        if (contains(key)) {
+            HASH_LOG("key " << key << " already present" << endl);
+            return;
+        }
+        if (cur.count + 1 > cur.size * MAX_LOAD) grow();
+        int i = cur.place(key);
+        HASH_LOG("inserted " << key << " at index " << i << endl);
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+    // membership without any output
+    bool contains(int key) {
+        return cur.find(key) != -1 || findold(key) != -1;
+    }
+
+    // search key
+    bool search(int key) {
+        HASH_COUNT_PROBES(OP_SEARCH);
+        int i = cur.find(key);
+        if (i != -1) {
+            HASH_LOG("key " << key << " found at index " << i << endl);
+            return true;
+        }
+        i = findold(key);
+        if (i != -1) {
+            HASH_LOG("key " << key << " found at index " << i << " of the old array" << endl);
+            return true;
+        }
+        HASH_LOG("key " << key << " not found!" << endl);
+        return false;
+    }
+
+    // delete key
+    void remove(int key) {
+        HASH_COUNT_PROBES(OP_DELETE);
+        int i = cur.find(key);
+        int j = i == -1 ? findold(key) : -1;
+        if (i != -1) {
+            cur.erase(i);
+            HASH_LOG("key " << key << " deleted from index " << i << endl);
+        } else if (j != -1) {
+            gone[j] = true;
+            old.count--;
+            HASH_LOG("key " << key << " deleted from index " << j << " of the old array" << endl);
+        } else {
+            HASH_LOG("key " << key << " not found, cannot delete!" << endl);
+        }
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+#ifdef HASH_STATS
+    hash_stats stats;
+
+    // the counters plus a snapshot of the current array; chains are runs of occupied slots
+    hash_stats& statistics() {
+        stats.keys = cur.count;
+        stats.slots = cur.size;
+        stats.tombstones = 0;
+        stats.runs(cur.size, [&](int i) { return cur.slots[i].dist != -1; });
+        return stats;
+    }
+#endif
+
+    // display table
+    void display() {
+        if (migrating()) migrate(old.size);
+        cout << "\nhash table (linear probing, robin hood):" << endl;
+        for (int i = 0; i < cur.size; i++) {
+            if (cur.slots[i].dist == -1)
+                cout << i << " --> [empty]" << endl;
+            else
+                cout << i << " --> " << cur.slots[i].key << " (distance " << cur.slots[i].dist << ")" << endl;
+        }
+    }
+};
@@ -0,0 +1,210 @@
+#pragma once
+#include <iostream>
+#include <vector>
+#include <list>
+#include "hash_stats.h"
+using namespace std;
+
+class SeparateChaining
+{
+    // double the bucket count once there are more keys than buckets
+    static constexpr double MAX_LOAD = 1.0;
+    // old buckets split into the new ones by every insert or delete while the table grows
+    static constexpr int MIGRATE_STEP = 16;
+
+    vector<list<int>> hashtable;
+    int size;
+    int count; // keys in hashtable
+
+    // while growing, the half-size bucket array is split a few buckets per operation
+    vector<list<int>> oldtable;
+    vector<bool> moved; // old buckets already split
+    int cursor = -1;    // next old bucket for the background steps; -1 when not growing
+
+    int bucket(int key, int m)
+    {
+        int i = key % m;
+        return i < 0 ? i + m : i;
+    }
+
+    bool migrating()
+    {
+        return cursor >= 0;
+    }
+
+    // with sizes s and 2s, k % 2s is either k % s or k % s + s, so old bucket i splits into
+    // new buckets i and i + s only. splice relinks the nodes without allocating
+    void split(int i)
+    {
+        if (moved[i])
+            return;
+        moved[i] = true;
+        list<int> &chain = oldtable[i];
+        while (!chain.empty())
+        {
+            list<int> &target = hashtable[hashfunction(chain.front())];
+            target.splice(target.end(), chain, chain.begin());
+            count++;
+        }
+    }
+
+    void migrate(int steps)
+    {
+        HASH_PAUSE_PROBES();
+        int oldsize = oldtable.size();
+        for (int s = 0; s < steps && cursor < oldsize; s++, cursor++)
+            split(cursor);
+        if (cursor == oldsize)
+        {
+            oldtable = vector<list<int>>();
+            moved = vector<bool>();
+            cursor = -1;
+        }
+    }
+
+    void grow()
+    {
+        if (migrating())
+            migrate(oldtable.size());
+        HASH_LOG("table grows from " << size << " to " << 2 * size << " buckets" << endl);
+        HASH_STATS_ONLY(stats.resize(size, 2 * size);)
+        oldtable.swap(hashtable);
+        moved.assign(size, false);
+        size *= 2;
+        hashtable = vector<list<int>>(size);
+        count = 0;
+        cursor = 0;
+    }
+
+    // the chain that holds key right now
+    list<int> &chainof(int key)
+    {
+        if (migrating())
+        {
+            int i = bucket(key, oldtable.size());
+            if (!moved[i])
+                return oldtable[i];
+        }
+        return hashtable[hashfunction(key)];
+    }
+
+public:
+    // constructor
+    SeparateChaining(int s)
+    {
+        size = s;
+        count = 0;
+        hashtable.resize(size);
+    }
+
+    //  hash function - simple modulo to calculate index, never negative
+    int hashfunction(int key)
+    {
+        return bucket(key, size);
+    }
+
+    // insert fucntion
+    void insert(int key)
+    {
+        HASH_COUNT_PROBES(OP_INSERT);
+        if (count + 1 > size * MAX_LOAD)
+            grow();
+        // the one old bucket that feeds this bucket is split first, so the chain is complete
+        if (migrating())
+            split(bucket(key, oldtable.size()));
+        int i = hashfunction(key);
+        hashtable[i].push_back(key);
+        count++;
+        HASH_LOG(key << " inserted at index " << i << endl);
+        if (migrating())
+            migrate(MIGRATE_STEP);
+    }
+
+    // search function
+    bool search(int key)
+    {
+        HASH_COUNT_PROBES(OP_SEARCH);
+        for (int k : chainof(key))
+        {
+            HASH_PROBE();
+            if (k == key)
+            {
+                HASH_LOG("Key " << key << " found at index " << hashfunction(key) << endl);
+                return true;
+            }
+        }
+        HASH_LOG("Key " << key << " not found!" << endl);
+        return false;
+    }
+
+    // delete fucntion
+    void deletekey(int key)
+    {
+        HASH_COUNT_PROBES(OP_DELETE);
+        // Step 1: Find index using hash function (splitting its old bucket first while growing)
+        if (migrating())
+            split(bucket(key, oldtable.size()));
+        int i = hashfunction(key);
+
+        // Step 2: Get reference to the chain (bucket) at that index
+        auto &chain = hashtable[i];
+
+        // Step 3: Traverse through the chain to find the key
+        for (auto it = chain.begin(); it != chain.end(); it++)
+        {
+            HASH_PROBE();
+            if (*it == key) // If key is found in this chain
+            {
+                chain.erase(it); // Step 4: Erase the key from chain
+                count--;
+                HASH_LOG(key << " deleted from index " << i << endl);
+                if (migrating())
+                    migrate(MIGRATE_STEP);
+                return;
+            }
+        }
+
+        // Step 5: If key not found in this chain
+        HASH_LOG("Key " << key << " not found, cannot delete!" << endl);
+        if (migrating())
+            migrate(MIGRATE_STEP);
+    }
+
+#ifdef HASH_STATS
+    hash_stats stats;
+
+    // the counters plus a snapshot of the current buckets; chains[n] counts buckets of n keys, empty ones included
+    hash_stats &statistics()
+    {
+        stats.keys = count;
+        stats.slots = size;
+        stats.tombstones = 0;
+        stats.chains.clear();
+        for (auto &chain : hashtable)
+            stats.chain(chain.size());
+        return stats;
+    }
+#endif
+
+    void printtable()
+    {
+        if (migrating())
+            migrate(oldtable.size());
+        for(int i = 0;i<size;i++){
+            cout << i << " : ";
+            if (!hashtable[i].empty())
+            {
+                for (int k : hashtable[i])
+                {
+                    cout << k << " -> ";
+                }
+                cout << "NULL";
+            }
+            else
+            {
+                cout << "empty";
+            }
+            cout << endl;
+             }
+    }
+};
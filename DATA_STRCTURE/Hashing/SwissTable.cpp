@@ -0,0 +1,31 @@
+#include <iostream>
+#include <vector>
+#include "SwissTable.h"
+using namespace std;
+
+int main() {
+    int m = 7; // hash table size, rounded up to one group of 16
+    swisstable h(m);
+
+    // hardcoded values
+    int values[] = {50, 21, 58, 17, 28, 35};
+
+    cout << "inserting keys...\n";
+    for (int k : values) {
+        h.insert(k);
+    }
+
+    h.display();
+
+    cout << "\nsearching keys...\n";
+    h.search(21);
+    h.search(99);
+
+    cout << "\ndeleting keys...\n";
+    h.remove(21);
+    h.remove(99);
+
+    h.display();
+
+    return 0;
+}
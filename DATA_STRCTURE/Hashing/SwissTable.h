@@ -0,0 +1,260 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SWISS_SSE2 1
+#endif
+#include "hash_stats.h"
+using namespace std;
+
+// open addressing with a separate control byte per slot, probed 16 slots at a time.
+// a control byte is EMPTY, DELETED, or the low 7 bits of the key's hash; keys are only
+// compared where that fragment matches
+class swisstable {
+    // grow (or clean up) once keys plus deleted marks would fill more than 7 of every 8 slots
+    static constexpr double MAX_LOAD = 0.875;
+    // old groups moved to the new arrays by every insert or remove while the table is rebuilt
+    static constexpr int MIGRATE_STEP = 1;
+
+    static constexpr int GROUP = 16;
+    static constexpr int8_t EMPTY = -128;  // 0b10000000
+    static constexpr int8_t DELETED = -2;  // 0b11111110, full slots are 0b0xxxxxxx
+
+    struct table {
+        vector<int8_t> ctrl;
+        vector<int> hashtable;
+        int groups = 0; // power of two
+        int size = 0;   // groups * GROUP slots
+        int count = 0;
+        int deleted = 0;
+
+        void init(int g) {
+            groups = g;
+            size = groups * GROUP;
+            count = deleted = 0;
+            ctrl.assign(size, EMPTY);
+            hashtable.assign(size, 0);
+        }
+
+        // one bit per slot of group g whose control byte equals b
+        unsigned match(int g, int8_t b) {
+#ifdef SWISS_SSE2
+            __m128i c = _mm_loadu_si128((const __m128i*)(ctrl.data() + g * GROUP));
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8(b)));
+#else
+            unsigned bits = 0;
+            for (int i = 0; i < GROUP; i++) bits |= (unsigned)(ctrl[g * GROUP + i] == b) << i;
+            return bits;
+#endif
+        }
+        // slots of group g that are EMPTY or DELETED: exactly the bytes with the top bit set
+        unsigned matchfree(int g) {
+#ifdef SWISS_SSE2
+            return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(ctrl.data() + g * GROUP)));
+#else
+            unsigned bits = 0;
+            for (int i = 0; i < GROUP; i++) bits |= (unsigned)(ctrl[g * GROUP + i] < 0) << i;
+            return bits;
+#endif
+        }
+
+        // groups are visited g, g+1, g+3, g+6, ...: triangular steps reach every group of a power of two table
+        int nextgroup(int g, int step) {
+            return (g + step) & (groups - 1);
+        }
+
+        // index of key, or -1. a group with an EMPTY slot ends the search: insert would have used it
+        int find(int key, uint64_t h) {
+            int8_t fragment = h & 0x7F;
+            int g = (h >> 7) & (groups - 1);
+            for (int step = 1; step <= groups; step++) {
+                HASH_PROBE();
+                for (unsigned bits = match(g, fragment); bits; bits &= bits - 1) {
+                    int i = g * GROUP + __builtin_ctz(bits);
+                    if (hashtable[i] == key) return i;
+                }
+                if (match(g, EMPTY)) return -1;
+                g = nextgroup(g, step);
+            }
+            return -1;
+        }
+
+        // first EMPTY or DELETED slot along the key's groups
+        int place(int key, uint64_t h) {
+            int g = (h >> 7) & (groups - 1);
+            for (int step = 1; ; step++) {
+                HASH_PROBE();
+                unsigned bits = matchfree(g);
+                if (bits) {
+                    int i = g * GROUP + __builtin_ctz(bits);
+                    if (ctrl[i] == DELETED) deleted--;
+                    ctrl[i] = h & 0x7F;
+                    hashtable[i] = key;
+                    count++;
+                    return i;
+                }
+                g = nextgroup(g, step);
+            }
+        }
+
+        // if the group still has an EMPTY slot no search ever went past it, so the slot can be
+        // EMPTY again; otherwise searches for later keys rely on it and it becomes DELETED
+        void erase(int i) {
+            if (match(i / GROUP, EMPTY)) {
+                ctrl[i] = EMPTY;
+            } else {
+                ctrl[i] = DELETED;
+                deleted++;
+            }
+            count--;
+        }
+    };
+
+    table cur;         // where inserts go
+    table old;         // the arrays being emptied while the table is rebuilt
+    int migrated = -1; // old groups below this are already in cur; -1 when not rebuilding
+
+    bool migrating() {
+        return migrated >= 0;
+    }
+
+    void migrate(int steps) {
+        HASH_PAUSE_PROBES();
+        for (int s = 0; s < steps && migrated < old.groups; s++, migrated++) {
+            for (int i = migrated * GROUP; i < (migrated + 1) * GROUP; i++) {
+                if (old.ctrl[i] >= 0) cur.place(old.hashtable[i], hashfunction(old.hashtable[i]));
+            }
+        }
+        if (migrated == old.groups) {
+            old = table();
+            migrated = -1;
+        }
+    }
+
+    // mostly deleted marks: rebuild at the same size to drop them. mostly keys: double
+    void rebuild() {
+        if (migrating()) migrate(old.groups); // only if a previous rebuild could not finish in time
+        int groups = cur.count + 1 > cur.size * MAX_LOAD / 2 ? 2 * cur.groups : cur.groups;
+        if (groups == cur.groups)
+            HASH_LOG("table rebuilt at " << cur.size << " slots to drop " << cur.deleted << " deleted marks" << endl);
+        else
+            HASH_LOG("table grows from " << cur.size << " to " << groups * GROUP << " slots" << endl);
+        HASH_STATS_ONLY(stats.resize(cur.size, groups * GROUP);)
+        old = move(cur);
+        cur.init(groups);
+        migrated = 0;
+    }
+
+    // slot of key in the old arrays if it still lives there, or -1. removals there go through
+    // erase like anywhere else, and a migrated group is never read again
+    int findold(int key, uint64_t h) {
+        if (!migrating()) return -1;
+        int i = old.find(key, h);
+        return i >= migrated * GROUP ? i : -1;
+    }
+
+public:
+    // constructor: room for at least m keys, rounded up to whole groups
+    swisstable(int m) {
+        int groups = 1;
+        while (groups * GROUP < m) groups *= 2;
+        cur.init(groups);
+    }
+
+    // hash function: murmur3 finalizer, so the 7 bit fragment and the group index are
+    // both well mixed even for sequential keys
+    uint64_t hashfunction(int key) {
+        uint64_t h = (uint32_t)key;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // insert key
+    void insert(int key) {
+        HASH_COUNT_PROBES(OP_INSERT);
+        if (contains(key)) {
+            HASH_LOG("key " << key << " already present" << endl);
+            return;
+        }
+        if (cur.count + cur.deleted + 1 > cur.size * MAX_LOAD) rebuild();
+        int i = cur.place(key, hashfunction(key));
+        HASH_LOG("inserted " << key << " at index " << i << endl);
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+    // membership without any output
+    bool contains(int key) {
+        uint64_t h = hashfunction(key);
+        return cur.find(key, h) != -1 || findold(key, h) != -1;
+    }
+
+    // search key
+    bool search(int key) {
+        HASH_COUNT_PROBES(OP_SEARCH);
+        uint64_t h = hashfunction(key);
+        int i = cur.find(key, h);
+        if (i != -1) {
+            HASH_LOG("key " << key << " found at index " << i << endl);
+            return true;
+        }
+        i = findold(key, h);
+        if (i != -1) {
+            HASH_LOG("key " << key << " found at index " << i << " of the old arrays" << endl);
+            return true;
+        }
+        HASH_LOG("key " << key << " not found!" << endl);
+        return false;
+    }
+
+    // delete key
+    void remove(int key) {
+        HASH_COUNT_PROBES(OP_DELETE);
+        uint64_t h = hashfunction(key);
+        int i = cur.find(key, h);
+        int j = i == -1 ? findold(key, h) : -1;
+        if (i != -1) {
+            cur.erase(i);
+            HASH_LOG("key " << key << " deleted from index " << i << endl);
+        } else if (j != -1) {
+            old.erase(j);
+            HASH_LOG("key " << key << " deleted from index " << j << " of the old arrays" << endl);
+        } else {
+            HASH_LOG("key " << key << " not found, cannot delete!" << endl);
+        }
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+#ifdef HASH_STATS
+    hash_stats stats;
+
+    // the counters plus a snapshot of the current arrays; chains are runs of full or deleted slots
+    hash_stats& statistics() {
+        stats.keys = cur.count;
+        stats.slots = cur.size;
+        stats.tombstones = cur.deleted;
+        stats.runs(cur.size, [&](int i) { return cur.ctrl[i] != EMPTY; });
+        return stats;
+    }
+#endif
+
+    // display table
+    void display() {
+        if (migrating()) migrate(old.groups);
+        cout << "\nhash table (swiss table, " << cur.groups << " group(s) of " << GROUP << "):" << endl;
+        for (int i = 0; i < cur.size; i++) {
+            if (cur.ctrl[i] == EMPTY)
+                cout << i << " --> [empty]" << endl;
+            else if (cur.ctrl[i] == DELETED)
+                cout << i << " --> [deleted]" << endl;
+            else
+                cout << i << " --> " << cur.hashtable[i] << " (fragment " << (int)cur.ctrl[i] << ")" << endl;
+        }
+    }
+};
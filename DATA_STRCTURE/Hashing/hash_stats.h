@@ -0,0 +1,159 @@
+// compile-time switches shared by the int tables in this folder:
+//
+//   -DHASH_QUIET   the per-operation messages ("inserted 50 at index 1", ...) compile away.
+//                  display / printtable still print, that is what they are for
+//   -DHASH_STATS   every table gets a `stats` member: probe-length histograms per operation type
+//                  and resize events, plus statistics() for load factor, tombstones and chain lengths
+//
+// both default to off; with HASH_STATS off the counters and the code updating them do not exist.
+#pragma once
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#ifdef HASH_QUIET
+#define HASH_LOG(x) do { if (false) std::cout << x; } while (0) // still type-checked, never printed
+#else
+#define HASH_LOG(x) do { std::cout << x; } while (0)
+#endif
+
+// statements that only exist in stats builds
+#ifdef HASH_STATS
+#define HASH_STATS_ONLY(...) __VA_ARGS__
+#else
+#define HASH_STATS_ONLY(...)
+#endif
+
+enum hash_op { OP_INSERT, OP_SEARCH, OP_DELETE, HASH_OPS };
+
+// HASH_PROBE() marks one probe step. HASH_COUNT_PROBES(op) at the top of a public operation records
+// the steps taken until it returns in the table's `stats`; HASH_PAUSE_PROBES() leaves out the rest
+// of the enclosing block, for migration work done on the side
+#ifdef HASH_STATS
+inline long long hash_probe_count = 0;
+#define HASH_PROBE() (hash_probe_count++)
+#define HASH_COUNT_PROBES(op) probe_scope hash_probe_scope_(stats, op)
+#define HASH_PAUSE_PROBES() probe_pause hash_probe_pause_
+#else
+#define HASH_PROBE() ((void)0)
+#define HASH_COUNT_PROBES(op) ((void)0)
+#define HASH_PAUSE_PROBES() ((void)0)
+#endif
+
+// what one probe counts depends on the table: slots for open addressing, 16-slot groups for the
+// swiss table, keys compared for separate chaining
+struct hash_stats {
+    static constexpr int LONGEST = 64; // longer probes are counted as 64
+
+    long long probes[HASH_OPS][LONGEST + 1] = {};
+    std::vector<std::pair<long long, long long>> resizes; // (old size, new size); equal sizes drop tombstones
+
+    // snapshot of the current array, filled in by the table's statistics()
+    long long keys = 0;
+    long long slots = 0; // slots, or buckets for chaining
+    long long tombstones = 0;
+    std::vector<long long> chains; // chains[n]: buckets holding n keys, or runs of n used slots in a row
+
+    void probe(hash_op op, int n) {
+        probes[op][n < LONGEST ? n : LONGEST]++;
+    }
+
+    void resize(long long from, long long to) {
+        resizes.push_back({from, to});
+    }
+
+    void chain(size_t n) {
+        if (n >= chains.size()) chains.resize(n + 1);
+        chains[n]++;
+    }
+
+    // chain(n) for every maximal run of n slots where used(i) holds
+    template <class Used>
+    void runs(long long size, Used used) {
+        chains.clear();
+        size_t run = 0;
+        for (long long i = 0; i < size; i++) {
+            if (used(i)) {
+                run++;
+            } else if (run) {
+                chain(run);
+                run = 0;
+            }
+        }
+        if (run) chain(run);
+    }
+
+    long long operations(hash_op op) const {
+        long long n = 0;
+        for (long long c : probes[op]) n += c;
+        return n;
+    }
+
+    double mean(hash_op op) const {
+        long long n = 0, sum = 0;
+        for (int i = 0; i <= LONGEST; i++) {
+            n += probes[op][i];
+            sum += probes[op][i] * i;
+        }
+        return n ? (double)sum / n : 0;
+    }
+
+    // smallest length that covers fraction p of the operations
+    int percentile(hash_op op, double p) const {
+        long long need = (long long)(p * operations(op) + 0.5), seen = 0;
+        for (int i = 0; i <= LONGEST; i++) {
+            seen += probes[op][i];
+            if (seen >= need && seen > 0) return i;
+        }
+        return 0;
+    }
+
+    double load_factor() const {
+        return slots ? (double)keys / slots : 0;
+    }
+
+    double tombstone_ratio() const {
+        return slots ? (double)tombstones / slots : 0;
+    }
+
+    void print(std::ostream& os) const {
+        static const char* names[HASH_OPS] = {"insert", "search", "delete"};
+        std::ios::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        os << std::fixed << std::setprecision(2);
+        for (int op = 0; op < HASH_OPS; op++) {
+            hash_op o = (hash_op)op;
+            if (!operations(o)) continue;
+            os << "  " << names[op] << " probes: mean " << mean(o) << ", p50 " << percentile(o, 0.5) << ", p99 "
+               << percentile(o, 0.99) << ", max " << (percentile(o, 1.0) == LONGEST ? ">= " : "") << percentile(o, 1.0)
+               << "  (" << operations(o) << " ops)" << std::endl;
+        }
+        long long n = 0, sum = 0;
+        for (size_t i = 0; i < chains.size(); i++) {
+            n += chains[i];
+            sum += chains[i] * i;
+        }
+        os << "  load " << load_factor() << ", tombstones " << tombstone_ratio() << ", chains: mean "
+           << (n ? (double)sum / n : 0) << ", longest " << (chains.empty() ? 0 : chains.size() - 1) << std::endl;
+        os << "  resizes: " << resizes.size();
+        for (auto& r : resizes) os << "  " << r.first << "->" << r.second;
+        os << std::endl;
+        os.flags(flags);
+        os.precision(precision);
+    }
+};
+
+#ifdef HASH_STATS
+struct probe_scope {
+    hash_stats& stats;
+    hash_op op;
+    probe_scope(hash_stats& s, hash_op o) : stats(s), op(o) { hash_probe_count = 0; }
+    ~probe_scope() { stats.probe(op, hash_probe_count < hash_stats::LONGEST ? (int)hash_probe_count : hash_stats::LONGEST); }
+};
+
+struct probe_pause {
+    long long saved = hash_probe_count;
+    ~probe_pause() { hash_probe_count = saved; }
+};
+#endif
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "hash_table.h"
+using namespace std;
+
+// every key from the old tables' sentinel list and both signs store normally
+void demo() {
+    hash_table<int, string> names(8);
+    int keys[] = {50, 21, -1, -2, 0, -58, 17, 1 << 30};
+    for (int k : keys) names.insert(k, "id " + to_string(k));
+
+    cout << "hash table (" << names.size() << " keys, " << names.capacity() << " slots):" << endl;
+    names.for_each([](int k, const string& v) { cout << k << " --> " << v << endl; });
+
+    cout << "\nsearching keys..." << endl;
+    for (int k : {-1, 99}) {
+        string* v = names.find(k);
+        cout << "key " << k << (v ? " found: " + *v : " not found!") << endl;
+    }
+
+    cout << "\ndeleting keys..." << endl;
+    for (int k : {-2, 99}) cout << "key " << k << (names.erase(k) ? " deleted" : " not found, cannot delete!") << endl;
+
+    // any key with a std::hash works, here with robin hood probing
+    hash_table<string, int, murmur_hash<string>, robin_hood_probe> counts;
+    string words[] = {"to", "be", "or", "not", "to", "be"};
+    for (const string& w : words) {
+        if (!counts.insert(w, 1)) ++*counts.find(w);
+    }
+    cout << "\nword counts:" << endl;
+    counts.for_each([](const string& w, int c) { cout << w << " --> " << c << endl; });
+}
+
+double seconds_since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// insert n keys, then look up every one of them (in another order) and n absent ones; ns per operation
+template <class Table>
+void bench(const char* name, const vector<int>& keys, const vector<int>& lookups, const vector<int>& absent) {
+    Table t;
+    auto start = chrono::steady_clock::now();
+    for (int k : keys) t.insert(k, k);
+    double insert = seconds_since(start);
+
+    long found = 0;
+    start = chrono::steady_clock::now();
+    for (int k : lookups) found += t.find(k) != nullptr;
+    double hit = seconds_since(start);
+    start = chrono::steady_clock::now();
+    for (int k : absent) found += t.find(k) != nullptr;
+    double miss = seconds_since(start);
+
+    double n = keys.size();
+    cout << name << "\t" << insert / n * 1e9 << "\t" << hit / n * 1e9 << "\t" << miss / n * 1e9
+         << (found == (long)keys.size() ? "" : "\twrong result") << endl;
+}
+
+// std::unordered_map with the same find signature
+struct std_table {
+    unordered_map<int, int> m;
+    void insert(int k, int v) { m.emplace(k, v); }
+    const int* find(int k) const {
+        auto it = m.find(k);
+        return it == m.end() ? nullptr : &it->second;
+    }
+};
+
+void bench_all(const char* title, const vector<int>& keys, const vector<int>& absent) {
+    vector<int> lookups = keys;
+    shuffle(lookups.begin(), lookups.end(), mt19937(2));
+    cout << "\n" << title << ", " << keys.size() << " keys, ns per operation\n";
+    cout << "table\t\t\tinsert\thit\tmiss" << endl;
+    bench<hash_table<int, int, murmur_hash<int>, linear_probe>>("linear, murmur\t", keys, lookups, absent);
+    bench<hash_table<int, int, fast_hash<int>, linear_probe>>("linear, fast\t", keys, lookups, absent);
+    bench<hash_table<int, int, murmur_hash<int>, quadratic_probe>>("quadratic, murmur", keys, lookups, absent);
+    bench<hash_table<int, int, murmur_hash<int>, double_hash_probe>>("double, murmur\t", keys, lookups, absent);
+    bench<hash_table<int, int, murmur_hash<int>, robin_hood_probe>>("robin hood, murmur", keys, lookups, absent);
+    bench<std_table>("std::unordered_map", keys, lookups, absent);
+}
+
+// one key at a time against the batch calls, on a table far larger than the last level cache
+template <class Probe>
+void bench_batch(const char* name, const vector<int>& keys, const vector<int>& lookups) {
+    using table = hash_table<int, int, murmur_hash<int>, Probe>;
+    double n = keys.size();
+    double insert, batchinsert, search, batchsearch;
+    long found = 0, batchfound = 0;
+    {
+        table t;
+        auto start = chrono::steady_clock::now();
+        for (int k : keys) t.insert(k, k);
+        insert = seconds_since(start);
+        start = chrono::steady_clock::now();
+        for (int k : lookups) found += t.find(k) != nullptr;
+        search = seconds_since(start);
+    }
+    {
+        table t;
+        auto start = chrono::steady_clock::now();
+        t.insert_batch(keys.data(), keys.data(), keys.size());
+        batchinsert = seconds_since(start);
+        start = chrono::steady_clock::now();
+        batchfound = t.search_batch(lookups.data(), lookups.size());
+        batchsearch = seconds_since(start);
+    }
+    cout << name << "\t" << insert / n * 1e9 << "\t" << batchinsert / n * 1e9 << "\t" << search / n * 1e9 << "\t"
+         << batchsearch / n * 1e9 << "\t" << search / batchsearch << "x" << (found == batchfound ? "" : "\twrong result") << endl;
+}
+
+int main(int argc, char** argv) {
+    demo();
+
+    int n = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    // sequential ids are the case where key % size clusters; the mixers spread them like random keys
+    vector<int> keys(n), absent(n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = i;
+        absent[i] = n + i;
+    }
+    bench_all("sequential ids", keys, absent);
+
+    mt19937 rng(1);
+    for (int i = 0; i < n; i++) keys[i] = (int)rng() & ~1;
+    for (int i = 0; i < n; i++) absent[i] = (int)rng() | 1;
+    bench_all("random keys", keys, absent);
+
+    // half of the lookups hit
+    int big = argc > 2 ? atoi(argv[2]) : 1 << 24;
+    keys.resize(big);
+    vector<int> lookups(big);
+    for (int i = 0; i < big; i++) keys[i] = (int)rng();
+    for (int i = 0; i < big; i++) lookups[i] = i % 2 ? keys[rng() % big] : (int)rng();
+    cout << "\nbatches, " << big << " keys, ns per operation\n";
+    cout << "probe\t\tinsert\tbatch\tsearch\tbatch\tspeedup" << endl;
+    bench_batch<linear_probe>("linear\t", keys, lookups);
+    bench_batch<quadratic_probe>("quadratic", keys, lookups);
+    bench_batch<double_hash_probe>("double\t", keys, lookups);
+    bench_batch<robin_hood_probe>("robin hood", keys, lookups);
+    return 0;
+}
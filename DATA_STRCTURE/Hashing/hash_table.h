@@ -0,0 +1,448 @@
+// open addressing hash map over any key and value type, with the hash and the probe sequence
+// chosen at compile time:
+//
+//   hash_table<int, string> names;                                         murmur mix, linear probing
+//   hash_table<long, double, fast_hash<long>, robin_hood_probe> prices;
+//   hash_table<string, int, murmur_hash<string>, quadratic_probe> counts;
+//
+// the capacity is a power of two, so the home slot is `hash & mask` instead of `key % size`. that
+// only works with a hash whose low bits depend on every key bit, which is what the mixers below are
+// for: sequential ids, multiples of the size and negative keys all spread evenly.
+//
+// whether a slot is empty, full or deleted lives in a separate byte array (robin hood keeps the
+// probe distance there), so no key value is reserved as a marker and -1, -2 or 0 store like any other.
+// policies are template parameters whose members are inlined into the probe loop; nothing is
+// called through a pointer.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// ---- hash policies: a key in, 64 well mixed bits out ----
+
+// murmur3 finalizer: every input bit affects every output bit
+inline uint64_t fmix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// integral keys are mixed directly; anything else goes through std::hash first, whose result is
+// often the value itself for integers and poorly spread for others
+template <class Key>
+uint64_t hash_input(const Key& key) {
+    if constexpr (std::is_integral<Key>::value || std::is_enum<Key>::value) return (uint64_t)key;
+    else return std::hash<Key>()(key);
+}
+
+template <class Key>
+struct murmur_hash {
+    uint64_t operator()(const Key& key) const { return fmix64(hash_input(key)); }
+};
+
+// one 64x64->128 multiply, folded: about half the latency of murmur and still good in the low bits
+template <class Key>
+struct fast_hash {
+    uint64_t operator()(const Key& key) const {
+#if defined(__SIZEOF_INT128__)
+        __uint128_t p = (__uint128_t)(hash_input(key) ^ 0x2D358DCCAA6C78A5ULL) * 0x9E3779B97F4A7C15ULL;
+        return (uint64_t)p ^ (uint64_t)(p >> 64);
+#else
+        return fmix64(hash_input(key));
+#endif
+    }
+};
+
+// lookups kept in flight at once by search_batch, and keys hashed ahead by insert_batch
+const size_t HASH_BATCH_WINDOW = 16;
+
+// ---- probe policies ----
+// a cursor starts at the home slot of hash h and walks a sequence that visits every slot of a
+// power-of-two table, so a probe always ends at an empty slot while the table is below max_load.
+// cursors are default constructible so the batch calls can keep arrays of them
+
+struct linear_probe {
+    static constexpr bool robin_hood = false;
+    static constexpr double max_load = 0.75;
+    struct cursor {
+        size_t pos = 0;
+        cursor() = default;
+        cursor(uint64_t h, size_t mask) : pos(h & mask) {}
+        void next(size_t mask) { pos = (pos + 1) & mask; }
+    };
+};
+
+// steps 1, 2, 3 ... land on home + i(i+1)/2, which is a permutation of the slots when the size is
+// a power of two
+struct quadratic_probe {
+    static constexpr bool robin_hood = false;
+    static constexpr double max_load = 0.75;
+    struct cursor {
+        size_t pos = 0;
+        size_t step = 0;
+        cursor() = default;
+        cursor(uint64_t h, size_t mask) : pos(h & mask) {}
+        void next(size_t mask) { pos = (pos + ++step) & mask; }
+    };
+};
+
+// the step comes from the high half of the hash; made odd, it is coprime with any power of two
+struct double_hash_probe {
+    static constexpr bool robin_hood = false;
+    static constexpr double max_load = 0.75;
+    struct cursor {
+        size_t pos = 0;
+        size_t step = 1;
+        cursor() = default;
+        cursor(uint64_t h, size_t mask) : pos(h & mask), step((size_t)(h >> 32) | 1) {}
+        void next(size_t mask) { pos = (pos + step) & mask; }
+    };
+};
+
+// linear probing where an insert takes the slot of any key closer to its home than itself, and
+// erase shifts the rest of the run back; no tombstones, and a lookup stops at the first key that
+// is closer to home than the searched key would be
+struct robin_hood_probe {
+    static constexpr bool robin_hood = true;
+    static constexpr double max_load = 0.9;
+    using cursor = linear_probe::cursor;
+};
+
+template <class Key, class Value, class Hash = murmur_hash<Key>, class Probe = linear_probe>
+class hash_table {
+    struct slot {
+        Key key;
+        Value value;
+    };
+
+    // per slot state. robin hood stores distance + 1 instead of FULL, so 0 stays empty for both;
+    // distances of 254 and up all read SATURATED and are recomputed from the hash when needed
+    static constexpr uint8_t EMPTY = 0;
+    static constexpr uint8_t DELETED = 1;
+    static constexpr uint8_t FULL = 2;
+    static constexpr uint8_t SATURATED = 255;
+    static constexpr size_t NOT_FOUND = ~(size_t)0;
+
+    slot* slots = nullptr;
+    uint8_t* meta = nullptr;
+    size_t cap = 0; // power of two
+    size_t count = 0;
+    size_t deleted = 0; // tombstones; always 0 with robin hood
+    Hash hasher;
+
+    static size_t round_up(size_t n) {
+        size_t c = 16;
+        while (c < n) c *= 2;
+        return c;
+    }
+
+    size_t mask() const { return cap - 1; }
+
+    static bool full(uint8_t m) {
+        if constexpr (Probe::robin_hood) return m != EMPTY;
+        else return m == FULL;
+    }
+
+    static uint8_t encode(size_t dist) {
+        return dist + 1 < SATURATED ? (uint8_t)(dist + 1) : SATURATED;
+    }
+
+    // robin hood distance of the key in slot pos
+    size_t distance(size_t pos) const {
+        if (meta[pos] != SATURATED) return meta[pos] - 1;
+        return (pos - (hasher(slots[pos].key) & mask())) & mask();
+    }
+
+    void allocate(size_t c) {
+        cap = c;
+        count = deleted = 0;
+        slots = std::allocator<slot>().allocate(cap);
+        meta = new uint8_t[cap]();
+    }
+
+    void release() {
+        if (!slots) return;
+        if constexpr (!std::is_trivially_destructible<slot>::value) {
+            for (size_t i = 0; i < cap; i++) {
+                if (full(meta[i])) slots[i].~slot();
+            }
+        }
+        std::allocator<slot>().deallocate(slots, cap);
+        delete[] meta;
+        slots = nullptr;
+        meta = nullptr;
+    }
+
+    void prefetch(size_t pos) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(meta + pos);
+        __builtin_prefetch(slots + pos);
+#endif
+    }
+
+    // one lookup in progress: the slot it is at and, for robin hood, how far that is from home
+    struct lookup {
+        typename Probe::cursor c;
+        size_t dist = 0;
+    };
+    enum probe_result { FOUND, ABSENT, MORE };
+
+    lookup begin_lookup(uint64_t h) const {
+        return {typename Probe::cursor(h, mask()), 0};
+    }
+
+    // checks the slot under the cursor; on MORE the cursor has moved on to the next slot
+    probe_result step(lookup& l, const Key& key) const {
+        uint8_t m = meta[l.c.pos];
+        if constexpr (Probe::robin_hood) {
+            // a resident with a smaller distance than ours here means key was never inserted
+            if (m == SATURATED) {
+                if (slots[l.c.pos].key == key) return FOUND;
+            } else {
+                if (m < encode(l.dist)) return ABSENT;
+                if (m == encode(l.dist) && slots[l.c.pos].key == key) return FOUND;
+            }
+            l.dist++;
+        } else {
+            if (m == EMPTY) return ABSENT;
+            if (m == FULL && slots[l.c.pos].key == key) return FOUND;
+        }
+        l.c.next(mask());
+        return MORE;
+    }
+
+    size_t find_index(const Key& key, uint64_t h) const {
+        lookup l = begin_lookup(h);
+        for (;;) {
+            probe_result r = step(l, key);
+            if (r != MORE) return r == FOUND ? l.c.pos : NOT_FOUND;
+        }
+    }
+
+    size_t find_index(const Key& key) const {
+        return find_index(key, hasher(key));
+    }
+
+    // key, with hash h, is known to be absent and there is room for it
+    void place(Key key, Value value, uint64_t h) {
+        typename Probe::cursor c(h, mask());
+        if constexpr (Probe::robin_hood) {
+            slot carry{std::move(key), std::move(value)};
+            for (size_t dist = 0;; dist++) {
+                if (meta[c.pos] == EMPTY) {
+                    new (&slots[c.pos]) slot(std::move(carry));
+                    meta[c.pos] = encode(dist);
+                    count++;
+                    return;
+                }
+                size_t resident = distance(c.pos);
+                if (resident < dist) {
+                    std::swap(carry, slots[c.pos]);
+                    meta[c.pos] = encode(dist);
+                    dist = resident;
+                }
+                c.next(mask());
+            }
+        } else {
+            while (meta[c.pos] == FULL) c.next(mask());
+            if (meta[c.pos] == DELETED) deleted--;
+            new (&slots[c.pos]) slot{std::move(key), std::move(value)};
+            meta[c.pos] = FULL;
+            count++;
+        }
+    }
+
+    void erase_at(size_t i) {
+        slots[i].~slot();
+        count--;
+        if constexpr (Probe::robin_hood) {
+            // pull the rest of the run one slot closer to home
+            size_t j = (i + 1) & mask();
+            while (meta[j] > 1) {
+                meta[i] = encode(distance(j) - 1);
+                new (&slots[i]) slot(std::move(slots[j]));
+                slots[j].~slot();
+                i = j;
+                j = (j + 1) & mask();
+            }
+            meta[i] = EMPTY;
+        } else {
+            meta[i] = DELETED;
+            deleted++;
+        }
+    }
+
+    // rebuilds into c slots, dropping every tombstone
+    void rehash(size_t c) {
+        slot* old = slots;
+        uint8_t* oldmeta = meta;
+        size_t oldcap = cap;
+        allocate(c);
+        for (size_t i = 0; i < oldcap; i++) {
+            if (!full(oldmeta[i])) continue;
+            uint64_t h = hasher(old[i].key);
+            place(std::move(old[i].key), std::move(old[i].value), h);
+            old[i].~slot();
+        }
+        std::allocator<slot>().deallocate(old, oldcap);
+        delete[] oldmeta;
+    }
+
+    // room for extra more keys. when keys plus tombstones pass max_load the table doubles, or, if
+    // it is mostly tombstones, is rebuilt at the same size
+    void make_room(size_t extra) {
+        while (count + deleted + extra > cap * Probe::max_load) {
+            rehash(count + extra > cap * Probe::max_load / 2 ? cap * 2 : cap);
+        }
+    }
+
+public:
+    explicit hash_table(size_t capacity = 16, Hash hash = Hash()) : hasher(hash) {
+        allocate(round_up(capacity));
+    }
+
+    ~hash_table() { release(); }
+
+    hash_table(const hash_table&) = delete;
+    hash_table& operator=(const hash_table&) = delete;
+
+    // the moved-from table is left empty and usable
+    hash_table(hash_table&& other) : hash_table() { swap(other); }
+    hash_table& operator=(hash_table&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(hash_table& other) noexcept {
+        std::swap(slots, other.slots);
+        std::swap(meta, other.meta);
+        std::swap(cap, other.cap);
+        std::swap(count, other.count);
+        std::swap(deleted, other.deleted);
+        std::swap(hasher, other.hasher);
+    }
+
+    // false, leaving the stored value alone, if key is already there
+    bool insert(const Key& key, const Value& value) {
+        uint64_t h = hasher(key);
+        if (find_index(key, h) != NOT_FOUND) return false;
+        make_room(1);
+        place(key, value, h);
+        return true;
+    }
+
+    // nullptr if absent; stays valid until the next insert or erase
+    Value* find(const Key& key) {
+        size_t i = find_index(key);
+        return i == NOT_FOUND ? nullptr : &slots[i].value;
+    }
+    const Value* find(const Key& key) const {
+        size_t i = find_index(key);
+        return i == NOT_FOUND ? nullptr : &slots[i].value;
+    }
+
+    bool contains(const Key& key) const { return find_index(key) != NOT_FOUND; }
+
+    bool erase(const Key& key) {
+        size_t i = find_index(key);
+        if (i == NOT_FOUND) return false;
+        erase_at(i);
+        return true;
+    }
+
+    // room for n keys without a rehash
+    void reserve(size_t n) {
+        size_t c = round_up((size_t)(n / Probe::max_load) + 1);
+        if (c > cap) rehash(c);
+    }
+
+    void clear() {
+        release();
+        allocate(16);
+    }
+
+    // ---- batches ----
+    // in a table much larger than the cache, a lookup waits for one or two misses, and the next key
+    // is not even hashed until then. the batch calls overlap those misses instead
+
+    // out[i] = find(keys[i]), or pass out = nullptr to only count; returns the number found.
+    // up to HASH_BATCH_WINDOW lookups are in flight: each prefetches its next slot and yields to
+    // the others, and a finished one is replaced by the next key right away (asynchronous memory
+    // access chaining), so a long probe does not hold up the rest of its group
+    size_t search_batch(const Key* keys, size_t n, Value** out = nullptr) {
+        struct flight {
+            size_t i;
+            lookup l;
+        };
+        flight window[HASH_BATCH_WINDOW];
+        size_t active = 0, next = 0, found = 0;
+        auto launch = [&](flight& f) {
+            f.i = next++;
+            f.l = begin_lookup(hasher(keys[f.i]));
+            prefetch(f.l.c.pos);
+        };
+        while (active < HASH_BATCH_WINDOW && next < n) launch(window[active++]);
+        while (active > 0) {
+            for (size_t w = 0; w < active;) {
+                flight& f = window[w];
+                probe_result r = step(f.l, keys[f.i]);
+                if (r == MORE) {
+                    prefetch(f.l.c.pos);
+                    w++;
+                    continue;
+                }
+                found += r == FOUND;
+                if (out) out[f.i] = r == FOUND ? &slots[f.l.c.pos].value : nullptr;
+                if (next < n) {
+                    launch(f);
+                    w++;
+                } else {
+                    f = window[--active];
+                }
+            }
+        }
+        return found;
+    }
+
+    // insert(keys[i], values[i]) for every i in order, so the first of two equal keys wins; returns
+    // the number inserted. keys are hashed HASH_BATCH_WINDOW at a time and all their home slots
+    // prefetched before the first of them is inserted (group prefetching)
+    size_t insert_batch(const Key* keys, const Value* values, size_t n) {
+        size_t inserted = 0;
+        uint64_t h[HASH_BATCH_WINDOW];
+        for (size_t base = 0; base < n; base += HASH_BATCH_WINDOW) {
+            size_t g = n - base < HASH_BATCH_WINDOW ? n - base : HASH_BATCH_WINDOW;
+            // grow before prefetching, so the prefetched slots are the ones the inserts use
+            make_room(g);
+            for (size_t j = 0; j < g; j++) {
+                h[j] = hasher(keys[base + j]);
+                prefetch(h[j] & mask());
+            }
+            for (size_t j = 0; j < g; j++) {
+                if (find_index(keys[base + j], h[j]) != NOT_FOUND) continue;
+                place(keys[base + j], values[base + j], h[j]);
+                inserted++;
+            }
+        }
+        return inserted;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    double load_factor() const { return (double)count / cap; }
+
+    // f(key, value) for every entry, in slot order
+    template <class F>
+    void for_each(F&& f) {
+        for (size_t i = 0; i < cap; i++) {
+            if (full(meta[i])) f(slots[i].key, slots[i].value);
+        }
+    }
+};
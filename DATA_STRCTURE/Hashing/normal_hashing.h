@@ -0,0 +1,158 @@
+#pragma once
+#include<iostream>
+#include<utility>
+#include<vector>
+#include "hash_stats.h"
+using namespace std;
+
+class NormalHashing {
+    // double the table once more than this fraction of the indices are used
+    static constexpr double MAX_LOAD = 0.5;
+    // old indices moved to the new table by every insert or delete while the table grows
+    static constexpr int MIGRATE_STEP = 16;
+
+    // one key per index, no collision handling
+    struct table {
+        vector<int> keys;
+        vector<bool> used;
+        int size = 0;
+        int count = 0;
+
+        void init(int s) {
+            size = s;
+            count = 0;
+            keys.assign(size, 0);
+            used.assign(size, false);
+        }
+
+        int index(int key) {
+            int i = key % size;
+            return i < 0 ? i + size : i;
+        }
+    };
+
+    table cur;             // the table operations work on
+    table old;             // the half-size table being split while growing
+    vector<bool> moved;    // old indices already split into cur
+    int cursor = -1;       // next old index the background steps split; -1 when not growing
+
+    bool migrating() {
+        return cursor >= 0;
+    }
+
+    // with sizes s and 2s, k % 2s is either k % s or k % s + s, so old index i only ever feeds
+    // new indices i and i + s, and nothing else lands there
+    void split(int i) {
+        if (moved[i]) return;
+        moved[i] = true;
+        if (!old.used[i]) return;
+        int key = old.keys[i];
+        int j = cur.index(key);
+        cur.keys[j] = key;
+        cur.used[j] = true;
+        cur.count++;
+    }
+
+    void migrate(int steps) {
+        HASH_PAUSE_PROBES();
+        for (int s = 0; s < steps && cursor < old.size; s++, cursor++) split(cursor);
+        if (cursor == old.size) {
+            old = table();
+            moved = vector<bool>();
+            cursor = -1;
+        }
+    }
+
+    void grow() {
+        if (migrating()) migrate(old.size);
+        HASH_LOG(" Table grows from " << cur.size << " to " << 2 * cur.size << " indices" << endl);
+        HASH_STATS_ONLY(stats.resize(cur.size, 2 * cur.size);)
+        old = move(cur);
+        cur.init(2 * old.size);
+        moved.assign(old.size, false);
+        cursor = 0;
+    }
+
+public:
+
+    // constructor
+    NormalHashing(int s) {
+        cur.init(s);
+    }
+
+    // hash function - simple modulo, never negative
+    int hashfunction(int key) {
+        return cur.index(key);
+    }
+
+    // insert function
+    void insert(int key) {
+        HASH_COUNT_PROBES(OP_INSERT);
+        if (cur.count + 1 > cur.size * MAX_LOAD) grow();
+        // the only old index that can still hold something for this index is split first
+        if (migrating()) split(old.index(key));
+        int i = hashfunction(key);
+        HASH_PROBE();
+        if (!cur.used[i]) {
+            cur.keys[i] = key;
+            cur.used[i] = true;
+            cur.count++;
+        } else {
+            HASH_LOG(" Collision occurred for key " << key << " at index " << i << endl);
+        }
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+    // search function
+    bool search(int key) {
+        HASH_COUNT_PROBES(OP_SEARCH);
+        // an index not split yet still has its key in the old table
+        table& t = migrating() && !moved[old.index(key)] ? old : cur;
+        int i = t.index(key);
+        HASH_PROBE();
+        if (t.used[i] && t.keys[i] == key) {
+            HASH_LOG("Key " << key << " found at index " << hashfunction(key) << endl);
+            return true;
+        }
+        HASH_LOG("Key " << key << " not found" << endl);
+        return false;
+    }
+
+    // delete function
+    void deleteKey(int key) {
+        HASH_COUNT_PROBES(OP_DELETE);
+        if (migrating()) split(old.index(key));
+        int i = hashfunction(key);
+        HASH_PROBE();
+        if (cur.used[i] && cur.keys[i] == key) {
+            cur.used[i] = false;
+            cur.count--;
+            HASH_LOG(" Deleted key " << key << " from index " << i << endl);
+        } else {
+            HASH_LOG(" Key " << key << " not found, cannot delete" << endl);
+        }
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+#ifdef HASH_STATS
+    hash_stats stats;
+
+    // the counters plus a snapshot of the current table; chains are runs of used indices
+    hash_stats& statistics() {
+        stats.keys = cur.count;
+        stats.slots = cur.size;
+        stats.tombstones = 0;
+        stats.runs(cur.size, [&](int i) { return cur.used[i]; });
+        return stats;
+    }
+#endif
+
+    // print hash table
+    void printtable() {
+        if (migrating()) migrate(old.size);
+        cout << "\n Hash Table:" << endl;
+        for (int i = 0; i < cur.size; i++) {
+            if (cur.used[i]) cout << "Index: " << i << " → Key: " << cur.keys[i] << endl;
+        }
+    }
+};
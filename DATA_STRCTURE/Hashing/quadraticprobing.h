@@ -0,0 +1,222 @@
+#pragma once
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "hash_stats.h"
+using namespace std;
+
+// smallest prime >= n
+inline int nextprime(int n) {
+    for (int p = n < 2 ? 2 : n; ; p++) {
+        bool isprime = true;
+        for (int j = 2; j * j <= p; j++) {
+            if (p % j == 0) {
+                isprime = false;
+                break;
+            }
+        }
+        if (isprime) return p;
+    }
+}
+
+class quadraticprobing {
+    // a quadratic sequence over a prime size reaches (size + 1) / 2 distinct slots, so an insert
+    // always finds room while at most half the slots are taken; deleted marks count as taken here
+    // because they lengthen every search that passes them
+    static constexpr double MAX_LOAD = 0.5;
+    // old slots moved to the new array by every insert or remove while the table is rebuilt
+    static constexpr int MIGRATE_STEP = 16;
+
+    enum state : unsigned char { EMPTY, FULL, DELETED };
+
+    struct table {
+        vector<int> hashtable;   // index -> key
+        vector<state> slotstate; // kept apart so a probe over states touches 1 byte per slot
+        int size = 0;
+        int count = 0;   // FULL slots
+        int deleted = 0; // DELETED slots
+
+        void init(int m) {
+            size = m;
+            count = deleted = 0;
+            hashtable.assign(size, 0);
+            slotstate.assign(size, EMPTY);
+        }
+
+        int home(int key) {
+            int index = key % size;
+            return index < 0 ? index + size : index;
+        }
+    };
+
+    table cur;         // where inserts go
+    table old;         // the array being emptied while the table is rebuilt
+    int migrated = -1; // old slots below this are already in cur; -1 when not rebuilding
+    int c1, c2;        // quadratic coefficients
+
+    // i-th slot of the probe sequence; long long so c2 * i * i cannot overflow
+    int probe(table& t, int mainindex, int i) {
+        return (mainindex + c1 * (long long)i + c2 * (long long)i * i) % t.size;
+    }
+
+    // index of key in t, or -1. an empty slot ends the sequence, a deleted one does not
+    int find(table& t, int key) {
+        int mainindex = t.home(key);
+        for (int i = 0; i < t.size; i++) {
+            int newindex = probe(t, mainindex, i);
+            HASH_PROBE();
+            if (t.slotstate[newindex] == EMPTY) return -1;
+            if (t.slotstate[newindex] == FULL && t.hashtable[newindex] == key) return newindex;
+        }
+        return -1;
+    }
+
+    // first slot of the sequence that is not FULL; the load limit guarantees there is one
+    int place(table& t, int key) {
+        int mainindex = t.home(key);
+        for (int i = 0; ; i++) {
+            int newindex = probe(t, mainindex, i);
+            HASH_PROBE();
+            if (t.slotstate[newindex] != FULL) {
+                if (t.slotstate[newindex] == DELETED) t.deleted--;
+                t.hashtable[newindex] = key;
+                t.slotstate[newindex] = FULL;
+                t.count++;
+                return newindex;
+            }
+        }
+    }
+
+    bool migrating() {
+        return migrated >= 0;
+    }
+
+    void migrate(int steps) {
+        HASH_PAUSE_PROBES();
+        for (int s = 0; s < steps && migrated < old.size; s++, migrated++) {
+            if (old.slotstate[migrated] == FULL) place(cur, old.hashtable[migrated]);
+        }
+        if (migrated == old.size) {
+            old = table();
+            migrated = -1;
+        }
+    }
+
+    // mostly deleted marks: rebuild at the same size to drop them. mostly keys: grow
+    void rebuild() {
+        if (migrating()) migrate(old.size); // only if a previous rebuild could not finish in time
+        int newsize = cur.count + 1 <= cur.size * MAX_LOAD / 2 ? cur.size : nextprime(2 * cur.size);
+        if (newsize == cur.size)
+            HASH_LOG("table rebuilt at " << newsize << " slots to drop " << cur.deleted << " deleted marks" << endl);
+        else
+            HASH_LOG("table grows from " << cur.size << " to " << newsize << " slots" << endl);
+        HASH_STATS_ONLY(stats.resize(cur.size, newsize);)
+        old = move(cur);
+        cur.init(newsize);
+        migrated = 0;
+    }
+
+    // slot of key in the old array if it still lives there, or -1
+    int findold(int key) {
+        if (!migrating()) return -1;
+        int i = find(old, key);
+        return i >= migrated ? i : -1;
+    }
+
+public:
+    // constructor; the size is rounded up to a prime so every insert finds a slot
+    quadraticprobing(int m, int c1_val = 1, int c2_val = 3) {
+        c1 = c1_val;
+        c2 = c2_val;
+        cur.init(nextprime(m));
+    }
+
+    // hash function, never negative
+    int hashfunction(int key) {
+        return cur.home(key);
+    }
+
+    // insert key
+    void insert(int key) {
+        HASH_COUNT_PROBES(OP_INSERT);
+        if (contains(key)) {
+            HASH_LOG("key " << key << " already present" << endl);
+            return;
+        }
+        if (cur.count + cur.deleted + 1 > cur.size * MAX_LOAD) rebuild();
+        int newindex = place(cur, key);
+        HASH_LOG("inserted " << key << " at index " << newindex << endl);
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+    // membership without any output
+    bool contains(int key) {
+        return find(cur, key) != -1 || findold(key) != -1;
+    }
+
+    // search key
+    bool search(int key) {
+        HASH_COUNT_PROBES(OP_SEARCH);
+        int newindex = find(cur, key);
+        if (newindex != -1) {
+            HASH_LOG("key " << key << " found at index " << newindex << endl);
+            return true;
+        }
+        newindex = findold(key);
+        if (newindex != -1) {
+            HASH_LOG("key " << key << " found at index " << newindex << " of the old array" << endl);
+            return true;
+        }
+        HASH_LOG("key " << key << " not found!" << endl);
+        return false;
+    }
+
+    // delete key
+    void remove(int key) {
+        HASH_COUNT_PROBES(OP_DELETE);
+        // quadratic sequences of different keys interleave, so keys cannot be shifted back
+        // like in linear probing; the slot keeps a deleted mark that insert may reuse
+        int newindex = find(cur, key);
+        table* t = &cur;
+        if (newindex == -1) {
+            newindex = findold(key);
+            t = &old;
+        }
+        if (newindex == -1) {
+            HASH_LOG("key " << key << " not found, cannot delete!" << endl);
+        } else {
+            t->slotstate[newindex] = DELETED;
+            t->count--;
+            t->deleted++;
+            HASH_LOG("key " << key << " deleted from index " << newindex << (t == &old ? " of the old array" : "") << endl);
+        }
+        if (migrating()) migrate(MIGRATE_STEP);
+    }
+
+#ifdef HASH_STATS
+    hash_stats stats;
+
+    // the counters plus a snapshot of the current array; chains are runs of full or deleted slots
+    hash_stats& statistics() {
+        stats.keys = cur.count;
+        stats.slots = cur.size;
+        stats.tombstones = cur.deleted;
+        stats.runs(cur.size, [&](int i) { return cur.slotstate[i] != EMPTY; });
+        return stats;
+    }
+#endif
+
+    // display table
+    void display() {
+        if (migrating()) migrate(old.size);
+        cout << "\nhash table (quadratic probing):" << endl;
+        for (int i = 0; i < cur.size; i++) {
+            if (cur.slotstate[i] == EMPTY)
+                cout << i << " --> [empty]" << endl;
+            else if (cur.slotstate[i] == DELETED)
+                cout << i << " --> [deleted]" << endl;
+            else
+                cout << i << " --> " << cur.hashtable[i] << endl;
+        }
+    }
+};
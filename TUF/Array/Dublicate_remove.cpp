@@ -1,20 +1,58 @@
 // dublicate remove form array
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <vector>
+#include "dedup.h"
+#include "hyperloglog.h"
+#include "mapped_file.h"
 using namespace std;
 
+// sorted input, compacted with SIMD, returns the new length
 int remove_dublicate(vector<int>& arr){
-    int i = 0;
-    for(int j = 1 ; j < arr.size();j++){
-        if(arr[i] != arr[j]){
-            i++;
-            arr[i] = arr[j];
-        }
-    }
-    return i +1;
+    return dedup_sorted(arr.data(), arr.size());
+}
+
+// any order; keeps the first copy of each value in place. pass a pool to split big arrays across it
+int remove_dublicate_unsorted(vector<int>& arr, thread_pool* pool = nullptr){
+    if(pool) return dedup_unsorted(arr.data(), arr.size(), *pool);
+    return dedup_unsorted_sequential(arr.data(), arr.size());
+}
+// sorted span, e.g. a file mapped with write_back so the compaction lands in the file
+size_t remove_dublicate(int_span arr){
+    return dedup_sorted(arr.data(), arr.size());
+}
+
+// roughly the length remove_dublicate would return, for data in any order and without touching it.
+// higher precision costs 2^precision bytes and gives ~1.04 / sqrt(2^precision) relative error
+double count_distinct_approx(int_span arr, int precision = HLL_DEFAULT_PRECISION, thread_pool* pool = nullptr){
+    if(pool) return parallel_hyperloglog(arr.data(), arr.size(), *pool, precision).estimate();
+    hyperloglog sketch(precision);
+    sketch.add(arr.data(), arr.size());
+    return sketch.estimate();
 }
 
-int main(){
+// ./Dublicate_remove [sorted.bin]                     removes the file's duplicates in place and shortens it
+// ./Dublicate_remove --estimate any.bin [precision]   estimates its distinct count, leaves it alone
+int main(int argc, char** argv){
+    if(argc > 2 && strcmp(argv[1], "--estimate") == 0){
+        mapped_file file(argv[2]);
+        int precision = argc > 3 ? atoi(argv[3]) : HLL_DEFAULT_PRECISION;
+        cout << "About " << llround(count_distinct_approx(file.span(), precision, &default_pool())) << " distinct values in "
+             << file.size() << endl;
+        return 0;
+    }
+    if(argc > 1){
+        size_t new_size;
+        {
+            mapped_file file(argv[1], true);
+            new_size = remove_dublicate(file.span());
+        }
+        truncate_ints(argv[1], new_size);
+        cout << "New size after removing duplicates: " << new_size << endl;
+        return 0;
+    }
     vector<int> arr = {1, 2, 2, 3, 4, 4, 5};
     int new_size = remove_dublicate(arr);
     cout << "New size after removing duplicates: " << new_size << endl;
@@ -22,5 +60,17 @@ int main(){
     for(int i = 0; i < new_size; i++){
         cout << arr[i] << " ";
     }
+    cout << endl;
+
+    vector<int> mixed = {4, 1, 4, 2, 1, 5, 2};
+    new_size = remove_dublicate_unsorted(mixed, &default_pool());
+    cout << "Unsorted input after removing duplicates: ";
+    for(int i = 0; i < new_size; i++){
+        cout << mixed[i] << " ";
+    }
+    cout << endl;
+
+    vector<int> repeated = {4, 1, 4, 2, 1, 5, 2};
+    cout << "Estimated distinct values without sorting: " << llround(count_distinct_approx(repeated)) << endl;
     return 0;
-}
\ No newline at end of file
+}
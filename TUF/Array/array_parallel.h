@@ -0,0 +1,79 @@
+// largest / second largest / check_sorted over big arrays split across the thread pool.
+// every worker runs array_scan on its own chunk and the partial results are merged: max and min
+// directly, the top two of each chunk folded into one top two, and sortedness is each chunk being
+// sorted plus every chunk boundary being in order.
+//
+// chunk edges fall on page boundaries and chunk c is pinned to worker c (thread_pool::submit_to),
+// so an array filled through first_touch_array has its pages allocated on the node of the thread
+// that scans them.
+#pragma once
+#include <cstdint>
+#include <new>
+#include <vector>
+#include "../thread_pool.h"
+#include "array_scan.h"
+
+// below this many elements one thread is already memory bound
+const size_t PARALLEL_SCAN_CUTOFF = 1 << 20;
+const size_t PAGE_BYTES = 4096;
+
+// start of chunk c when [a, a + n) is split into `chunks` page aligned pieces
+inline size_t page_chunk_begin(const int* a, size_t n, unsigned chunks, unsigned c){
+    if(c == 0) return 0;
+    if(c >= chunks) return n;
+    uintptr_t target = (uintptr_t)(a + n / chunks * c);
+    uintptr_t aligned = (target + PAGE_BYTES - 1) & ~(uintptr_t)(PAGE_BYTES - 1);
+    return std::min(n, (size_t)((const int*)aligned - a));
+}
+
+// runs f(chunk, begin, end) for every chunk, chunk c on worker c and never on the calling thread
+template <class F>
+void for_each_page_chunk(const int* a, size_t n, thread_pool& pool, F f){
+    unsigned chunks = pool.size();
+    thread_pool::task_group group(pool);
+    for(unsigned c = 0; c < chunks; c++){
+        size_t begin = page_chunk_begin(a, n, chunks, c);
+        size_t end = page_chunk_begin(a, n, chunks, c + 1);
+        if(begin < end) group.run_on(c, [=, &f]{ f(c, begin, end); });
+    }
+    group.wait();
+}
+
+inline array_scan_result parallel_array_scan(const int* a, size_t n, thread_pool& pool){
+    if(n < PARALLEL_SCAN_CUTOFF || pool.size() == 1) return array_scan(a, n);
+    std::vector<array_scan_result> parts(pool.size());
+    std::vector<size_t> begins(pool.size(), 0), ends(pool.size(), 0);
+    for_each_page_chunk(a, n, pool, [&](unsigned c, size_t begin, size_t end){
+        parts[c] = array_scan(a + begin, end - begin);
+        begins[c] = begin;
+        ends[c] = end;
+    });
+
+    // empty chunks were never run and add nothing
+    scan_merger merged;
+    for(unsigned c = 0; c < parts.size(); c++) merged.add(a + begins[c], ends[c] - begins[c], parts[c]);
+    return merged.result();
+}
+
+// int array whose pages are first written by the workers that will later scan them. the pool does
+// not pin threads, so this is a placement hint that holds as long as the scheduler keeps workers put.
+class first_touch_array {
+    int* ptr = nullptr;
+    size_t len = 0;
+
+public:
+    first_touch_array(size_t n, thread_pool& pool) : len(n){
+        ptr = static_cast<int*>(::operator new(n * sizeof(int), std::align_val_t(PAGE_BYTES)));
+        for_each_page_chunk(ptr, n, pool, [&](unsigned, size_t begin, size_t end){
+            std::fill(ptr + begin, ptr + end, 0);
+        });
+    }
+    ~first_touch_array(){ ::operator delete(ptr, std::align_val_t(PAGE_BYTES)); }
+    first_touch_array(const first_touch_array&) = delete;
+    first_touch_array& operator=(const first_touch_array&) = delete;
+
+    int* data(){ return ptr; }
+    const int* data() const { return ptr; }
+    size_t size() const { return len; }
+    int& operator[](size_t i){ return ptr[i]; }
+};
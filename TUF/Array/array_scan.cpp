@@ -0,0 +1,56 @@
+// largest, second largest, min and check_sorted in one pass over the array
+//
+//   g++ -O2 -std=c++17 -pthread array_scan.cpp -o array_scan
+//   ./array_scan [n]      also times the fused scan against three separate loops over n ints, and
+//                         the scan split across the default pool over a first-touch array
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "array_parallel.h"
+using namespace std;
+
+int main(int argc, char** argv){
+    vector<int> arr = {3, 5, 1, 8, 2};
+    array_scan_result r = array_scan(arr);
+    cout << "largest " << r.max << ", second largest " << (r.has_second ? r.second_max : -1) << ", min " << r.min
+         << ", sorted " << r.sorted << ", first out of order at " << r.first_unsorted << endl;
+
+    if(argc < 2) return 0;
+    size_t n = strtoull(argv[1], nullptr, 10);
+    vector<int> big(n);
+    for(size_t i = 0; i < n; i++) big[i] = i; // sorted, so no loop can stop early
+    auto start = chrono::steady_clock::now();
+    r = array_scan(big);
+    double fused = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    int mx = INT_MIN, sm = INT_MIN;
+    bool sorted = true;
+    for(int v : big) mx = max(mx, v);
+    for(int v : big){
+        if(v < mx && v > sm) sm = v;
+    }
+    for(size_t i = 1; i < n; i++){
+        if(big[i] < big[i - 1]){
+            sorted = false;
+            break;
+        }
+    }
+    double separate = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double gb = n * sizeof(int) / 1e9;
+    cout << "fused " << gb / fused << " GB/s, three loops " << 3 * gb / separate << " GB/s ("
+         << fused * 1e3 << " vs " << separate * 1e3 << " ms)" << (r.max == mx && r.second_max == sm && r.sorted == sorted ? "" : " MISMATCH") << endl;
+
+    thread_pool& pool = default_pool();
+    first_touch_array placed(n, pool);
+    for_each_page_chunk(placed.data(), n, pool, [&](unsigned, size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++) placed[i] = i;
+    });
+    start = chrono::steady_clock::now();
+    array_scan_result p = parallel_array_scan(placed.data(), n, pool);
+    double parallel = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "parallel " << gb / parallel << " GB/s on " << pool.size() << " threads"
+         << (p.max == r.max && p.second_max == r.second_max && p.sorted == r.sorted ? "" : " MISMATCH") << endl;
+    return 0;
+}
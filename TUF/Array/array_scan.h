@@ -0,0 +1,244 @@
+// one pass over an int array that answers largest, second largest, min and check_sorted together.
+// the AVX-512 and AVX2 kernels keep four independent sets of accumulators so the max / min chains
+// do not serialize, and test sortedness once per 4 vectors by comparing each vector with the same
+// data loaded one element earlier. the best kernel the cpu supports is picked once at run time.
+//
+// second largest is the largest value strictly below max. each lane tracks its own distinct top
+// two: a value equal to the lane max is replaced by INT_MIN before it can become the runner-up.
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct array_scan_result {
+    int max = INT_MIN;
+    int second_max = INT_MIN; // only valid when has_second
+    bool has_second = false;  // true iff the array holds at least two distinct values
+    int min = INT_MAX;
+    bool sorted = true;       // non-decreasing
+    size_t first_unsorted = 0; // smallest i with a[i] < a[i-1], or n when sorted
+};
+
+// running top two distinct values and min, folded one value at a time without branches
+struct scan_state {
+    int max = INT_MIN;
+    int second = INT_MIN;
+    int min = INT_MAX;
+
+    void push_top(int v){
+        second = std::max(second, v == max ? INT_MIN : std::min(max, v));
+        max = std::max(max, v);
+    }
+    void push(int v){
+        push_top(v);
+        min = std::min(min, v);
+    }
+};
+
+inline array_scan_result finish_scan(const scan_state& s, size_t n, size_t first_unsorted){
+    array_scan_result r;
+    if(n == 0) return r;
+    r.max = s.max;
+    r.min = s.min;
+    r.has_second = s.min < s.max;
+    r.second_max = r.has_second ? s.second : INT_MIN;
+    r.first_unsorted = first_unsorted;
+    r.sorted = first_unsorted == n;
+    return r;
+}
+
+// first i in [from, to) with a[i] < a[i-1], or n. from must be >= 1
+inline size_t find_descent(const int* a, size_t from, size_t to, size_t n){
+    for(size_t i = from; i < to; i++){
+        if(a[i] < a[i - 1]) return i;
+    }
+    return n;
+}
+
+inline array_scan_result array_scan_scalar(const int* a, size_t n){
+    scan_state s;
+    size_t first_unsorted = n;
+    for(size_t i = 0; i < n; i++){
+        s.push(a[i]);
+        if(i > 0 && a[i] < a[i - 1] && first_unsorted == n) first_unsorted = i;
+    }
+    return finish_scan(s, n, first_unsorted);
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ARRAY_SCAN_X86 1
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace scan_avx2 {
+const int W = 8;
+const int U = 4; // vectors per iteration, one accumulator set each
+
+inline array_scan_result scan(const int* a, size_t n){
+    if(n < 2 * W * U) return array_scan_scalar(a, n);
+    const __m256i sentinel = _mm256_set1_epi32(INT_MIN);
+    __m256i top[U], second[U], low[U];
+    for(int u = 0; u < U; u++){
+        top[u] = low[u] = _mm256_set1_epi32(a[0]);
+        second[u] = sentinel;
+    }
+    size_t first_unsorted = n;
+    // element 0 seeds the accumulators; the vector loop starts at 1 so a[i-1] is always readable
+    size_t i = 1;
+    for(; i + W * U <= n; i += W * U){
+        __m256i bad = _mm256_setzero_si256();
+        for(int u = 0; u < U; u++){
+            const int* p = a + i + u * W;
+            __m256i v = _mm256_loadu_si256((const __m256i*)p);
+            __m256i prev = _mm256_loadu_si256((const __m256i*)(p - 1));
+            bad = _mm256_or_si256(bad, _mm256_cmpgt_epi32(prev, v));
+            __m256i equal = _mm256_cmpeq_epi32(v, top[u]);
+            __m256i candidate = _mm256_blendv_epi8(_mm256_min_epi32(top[u], v), sentinel, equal);
+            second[u] = _mm256_max_epi32(second[u], candidate);
+            top[u] = _mm256_max_epi32(top[u], v);
+            low[u] = _mm256_min_epi32(low[u], v);
+        }
+        // taken at most once, so it costs nothing on sorted data
+        if(first_unsorted == n && !_mm256_testz_si256(bad, bad)) first_unsorted = find_descent(a, i, i + W * U, n);
+    }
+
+    scan_state s;
+    alignas(32) int tops[W], seconds[W], lows[W];
+    for(int u = 0; u < U; u++){
+        _mm256_store_si256((__m256i*)tops, top[u]);
+        _mm256_store_si256((__m256i*)seconds, second[u]);
+        _mm256_store_si256((__m256i*)lows, low[u]);
+        for(int l = 0; l < W; l++){
+            s.push_top(tops[l]);
+            s.push_top(seconds[l]);
+            s.min = std::min(s.min, lows[l]);
+        }
+    }
+    for(size_t j = i; j < n; j++) s.push(a[j]);
+    if(first_unsorted == n) first_unsorted = find_descent(a, i, n, n);
+    return finish_scan(s, n, first_unsorted);
+}
+} // namespace scan_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// gcc 12's avx512 intrinsics trip this on their own _mm512_undefined_* placeholders
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace scan_avx512 {
+const int W = 16;
+const int U = 4;
+
+inline array_scan_result scan(const int* a, size_t n){
+    if(n < 2 * W * U) return array_scan_scalar(a, n);
+    const __m512i sentinel = _mm512_set1_epi32(INT_MIN);
+    __m512i top[U], second[U], low[U];
+    for(int u = 0; u < U; u++){
+        top[u] = low[u] = _mm512_set1_epi32(a[0]);
+        second[u] = sentinel;
+    }
+    size_t first_unsorted = n;
+    size_t i = 1;
+    for(; i + W * U <= n; i += W * U){
+        __mmask16 bad = 0;
+        for(int u = 0; u < U; u++){
+            const int* p = a + i + u * W;
+            __m512i v = _mm512_loadu_si512(p);
+            __m512i prev = _mm512_loadu_si512(p - 1);
+            bad |= _mm512_cmpgt_epi32_mask(prev, v);
+            __mmask16 equal = _mm512_cmpeq_epi32_mask(v, top[u]);
+            __m512i candidate = _mm512_mask_blend_epi32(equal, _mm512_min_epi32(top[u], v), sentinel);
+            second[u] = _mm512_max_epi32(second[u], candidate);
+            top[u] = _mm512_max_epi32(top[u], v);
+            low[u] = _mm512_min_epi32(low[u], v);
+        }
+        if(first_unsorted == n && bad) first_unsorted = find_descent(a, i, i + W * U, n);
+    }
+
+    scan_state s;
+    alignas(64) int tops[W], seconds[W];
+    for(int u = 0; u < U; u++){
+        _mm512_store_si512(tops, top[u]);
+        _mm512_store_si512(seconds, second[u]);
+        for(int l = 0; l < W; l++){
+            s.push_top(tops[l]);
+            s.push_top(seconds[l]);
+        }
+        s.min = std::min(s.min, _mm512_reduce_min_epi32(low[u]));
+    }
+    for(size_t j = i; j < n; j++) s.push(a[j]);
+    if(first_unsorted == n) first_unsorted = find_descent(a, i, n, n);
+    return finish_scan(s, n, first_unsorted);
+}
+} // namespace scan_avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+#endif // x86
+
+typedef array_scan_result (*array_scan_fn)(const int*, size_t);
+
+inline array_scan_fn pick_array_scan(){
+#ifdef ARRAY_SCAN_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return scan_avx512::scan;
+    if(__builtin_cpu_supports("avx2")) return scan_avx2::scan;
+#endif
+    return array_scan_scalar;
+}
+
+inline array_scan_result array_scan(const int* a, size_t n){
+    static const array_scan_fn kernel = pick_array_scan();
+    return kernel(a, n);
+}
+inline array_scan_result array_scan(const std::vector<int>& arr){
+    return array_scan(arr.data(), arr.size());
+}
+
+// combines the scans of consecutive pieces of one array, fed in order: the top two of each piece
+// fold into one top two, and a descent is either inside a piece or across the edge between two.
+// used for chunks scanned in parallel and for data that arrives a block at a time.
+struct scan_merger {
+    scan_state s;
+    size_t count = 0;
+    size_t first_unsorted = SIZE_MAX;
+    int last = 0;
+
+    void add(const int* piece, size_t n, const array_scan_result& r){
+        if(n == 0) return;
+        s.push_top(r.max);
+        if(r.has_second) s.push_top(r.second_max);
+        s.min = std::min(s.min, r.min);
+        if(first_unsorted == SIZE_MAX){
+            if(count > 0 && piece[0] < last) first_unsorted = count;
+            else if(!r.sorted) first_unsorted = count + r.first_unsorted;
+        }
+        last = piece[n - 1];
+        count += n;
+    }
+    void add(const int* piece, size_t n){
+        add(piece, n, array_scan(piece, n));
+    }
+    array_scan_result result() const {
+        return finish_scan(s, count, first_unsorted == SIZE_MAX ? count : first_unsorted);
+    }
+};
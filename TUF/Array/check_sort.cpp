@@ -1,9 +1,13 @@
 #include <iostream>
 #include <vector>
+#include "array_parallel.h"
+#include "mapped_file.h"
 using namespace std;
 
-bool check_sorted(vector<int>& arr){
+// pass a pool to split big arrays across its workers
+bool check_sorted(vector<int>& arr, thread_pool* pool = nullptr){
     int n = arr.size();
+    if(pool && arr.size() >= PARALLEL_SCAN_CUTOFF) return parallel_array_scan(arr.data(), n, *pool).sorted;
     for(int i = 0 ; i<n-1 ;i++){
         if(arr[i]>arr[i+1]){
             return false;
@@ -11,8 +15,18 @@ bool check_sorted(vector<int>& arr){
     }
     return true;
 }
+// same over a span, e.g. a mapped file
+bool check_sorted(int_span arr, thread_pool* pool = nullptr){
+    return pool ? parallel_array_scan(arr.data(), arr.size(), *pool).sorted : array_scan(arr.data(), arr.size()).sorted;
+}
 
-int main(){
+// ./check_sort [file.bin]   with a file, its int32 contents are mapped instead of using the sample
+int main(int argc, char** argv){
+    if(argc > 1){
+        mapped_file file(argv[1]);
+        cout << check_sorted(file.span(), &default_pool());
+        return 0;
+    }
     vector<int> arr = {1, 2, 3, 4, 5};
     cout << check_sorted(arr);
     return 0;
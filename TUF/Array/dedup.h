@@ -0,0 +1,286 @@
+// duplicate removal without a branch per element.
+//
+// sorted input: each vector is compared with itself shifted one lane right (the lane shifted in is
+// the last element of the previous vector, kept in a register), which gives a keep mask of the
+// elements that differ from their left neighbour. the kept lanes are then packed to the front with
+// AVX-512 compress, or on AVX2 with a permute from a 256 entry lookup table, and stored at the
+// output cursor. the output never overtakes the input, so this works in place.
+//
+// unsorted input: values are hashed into partitions small enough that each partition's hash set
+// stays in cache. partitions are deduplicated in parallel, marking the first occurrence of every
+// value, and the marked elements are compacted in their original order.
+#pragma once
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "../thread_pool.h"
+
+// both modes return the new length; a[0..length) holds the distinct values, the rest is unspecified
+
+inline size_t dedup_sorted_scalar(int* a, size_t n){
+    if(n == 0) return 0;
+    size_t out = 1;
+    for(size_t i = 1; i < n; i++){
+        int x = a[i];
+        a[out] = x;
+        out += x != a[out - 1];
+    }
+    return out;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DEDUP_X86 1
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,popcnt"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+#endif
+namespace dedup_avx2 {
+const int W = 8;
+
+// entry m lists, as bytes, the lanes whose bit is set in m followed by filler
+struct compress_table {
+    uint64_t lanes[256];
+    compress_table(){
+        for(int m = 0; m < 256; m++){
+            uint64_t entry = 0;
+            int k = 0;
+            for(int lane = 0; lane < W; lane++){
+                if(m & (1 << lane)) entry |= (uint64_t)lane << (8 * k++);
+            }
+            lanes[m] = entry;
+        }
+    }
+};
+
+inline size_t dedup_sorted(int* a, size_t n){
+    if(n < 2 * W) return dedup_sorted_scalar(a, n);
+    static const compress_table table;
+    const __m256i shift_right = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    __m256i carry = _mm256_set1_epi32(a[0]); // element 0 is always kept
+    size_t out = 1;
+    size_t i = 1;
+    for(; i + W <= n; i += W){
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i prev = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, shift_right), carry, 0x01);
+        unsigned keep = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, prev))) & 0xFF;
+        __m256i order = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(table.lanes[keep]));
+        _mm256_storeu_si256((__m256i*)(a + out), _mm256_permutevar8x32_epi32(v, order));
+        out += _mm_popcnt_u32(keep);
+        carry = _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(7));
+    }
+    // the store above may have written filler past `out`, so the tail compares against a[out - 1]
+    for(; i < n; i++){
+        int x = a[i];
+        a[out] = x;
+        out += x != a[out - 1];
+    }
+    return out;
+}
+} // namespace dedup_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,popcnt"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,popcnt")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace dedup_avx512 {
+const int W = 16;
+
+inline size_t dedup_sorted(int* a, size_t n){
+    if(n < 2 * W) return dedup_sorted_scalar(a, n);
+    __m512i last = _mm512_set1_epi32(a[0]);
+    size_t out = 1;
+    size_t i = 1;
+    for(; i + W <= n; i += W){
+        __m512i v = _mm512_loadu_si512(a + i);
+        // lane 15 of the previous vector followed by lanes 0..14 of this one
+        __m512i prev = _mm512_alignr_epi32(v, last, 15);
+        __mmask16 keep = _mm512_cmpneq_epi32_mask(v, prev);
+        _mm512_mask_compressstoreu_epi32(a + out, keep, v);
+        out += _mm_popcnt_u32(keep);
+        last = v;
+    }
+    for(; i < n; i++){
+        int x = a[i];
+        a[out] = x;
+        out += x != a[out - 1];
+    }
+    return out;
+}
+} // namespace dedup_avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+#endif // x86
+
+typedef size_t (*dedup_fn)(int*, size_t);
+
+inline dedup_fn pick_dedup_sorted(){
+#ifdef DEDUP_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return dedup_avx512::dedup_sorted;
+    if(__builtin_cpu_supports("avx2")) return dedup_avx2::dedup_sorted;
+#endif
+    return dedup_sorted_scalar;
+}
+
+inline size_t dedup_sorted(int* a, size_t n){
+    static const dedup_fn kernel = pick_dedup_sorted();
+    return kernel(a, n);
+}
+
+// ---- unsorted input ----
+// below this the whole array goes through one hash set on the calling thread
+const size_t PARALLEL_DEDUP_CUTOFF = 1 << 18;
+// elements per partition, sized so a partition's set (2x slots of 5 bytes) fits in L2
+const size_t DEDUP_PARTITION_TARGET = 1 << 14;
+
+inline uint32_t dedup_hash(int x){
+    uint32_t h = x;
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    return h;
+}
+
+// open addressing set of ints, linear probing, never shrinks. insert() says whether x was new
+class dedup_set {
+    std::vector<int> keys;
+    std::vector<unsigned char> used;
+    uint32_t mask;
+
+public:
+    explicit dedup_set(size_t expected){
+        size_t slots = 16;
+        while(slots < 2 * expected) slots *= 2;
+        keys.resize(slots);
+        used.assign(slots, 0);
+        mask = slots - 1;
+    }
+    bool insert(int x, uint32_t h){
+        for(uint32_t slot = h & mask; ; slot = (slot + 1) & mask){
+            if(!used[slot]){
+                used[slot] = 1;
+                keys[slot] = x;
+                return true;
+            }
+            if(keys[slot] == x) return false;
+        }
+    }
+};
+
+inline size_t dedup_unsorted_sequential(int* a, size_t n){
+    dedup_set seen(n);
+    size_t out = 0;
+    for(size_t i = 0; i < n; i++){
+        int x = a[i];
+        a[out] = x;
+        out += seen.insert(x, dedup_hash(x));
+    }
+    return out;
+}
+
+// keeps the first occurrence of every value, in the original order
+inline size_t dedup_unsorted(int* a, size_t n, thread_pool& pool){
+    unsigned tasks = pool.size();
+    if(n < PARALLEL_DEDUP_CUTOFF || tasks == 1 || n > UINT32_MAX) return dedup_unsorted_sequential(a, n);
+
+    // the top bits of the hash pick the partition, the low bits the slot inside its set
+    int partition_bits = 0;
+    while(((size_t)1 << partition_bits) * DEDUP_PARTITION_TARGET < n && partition_bits < 12) partition_bits++;
+    size_t partitions = (size_t)1 << partition_bits;
+    auto partition_of = [&](uint32_t h){ return partition_bits == 0 ? 0 : h >> (32 - partition_bits); };
+    auto chunk_begin = [&](unsigned t){ return n * t / tasks; };
+    thread_pool::task_group group(pool);
+
+    // 1. count per (chunk, partition), then a partition-major prefix sum so each partition's
+    //    entries end up in index order
+    std::vector<size_t> offsets(tasks * partitions, 0);
+    for(unsigned t = 0; t < tasks; t++){
+        group.run([&, t]{
+            size_t* count = offsets.data() + t * partitions;
+            for(size_t i = chunk_begin(t); i < chunk_begin(t + 1); i++) count[partition_of(dedup_hash(a[i]))]++;
+        });
+    }
+    group.wait();
+    std::vector<size_t> partition_start(partitions + 1);
+    size_t sum = 0;
+    for(size_t p = 0; p < partitions; p++){
+        partition_start[p] = sum;
+        for(unsigned t = 0; t < tasks; t++){
+            size_t count = offsets[t * partitions + p];
+            offsets[t * partitions + p] = sum;
+            sum += count;
+        }
+    }
+    partition_start[partitions] = n;
+
+    // 2. scatter element indices by partition
+    std::vector<uint32_t> index(n);
+    for(unsigned t = 0; t < tasks; t++){
+        group.run([&, t]{
+            size_t* pos = offsets.data() + t * partitions;
+            for(size_t i = chunk_begin(t); i < chunk_begin(t + 1); i++) index[pos[partition_of(dedup_hash(a[i]))]++] = i;
+        });
+    }
+    group.wait();
+
+    // 3. every partition marks the first occurrence of each of its values
+    std::vector<unsigned char> keep(n, 0);
+    for(size_t p = 0; p < partitions; p++){
+        group.run([&, p]{
+            size_t begin = partition_start[p], end = partition_start[p + 1];
+            dedup_set seen(end - begin);
+            for(size_t k = begin; k < end; k++){
+                uint32_t i = index[k];
+                keep[i] = seen.insert(a[i], dedup_hash(a[i]));
+            }
+        });
+    }
+    group.wait();
+
+    // 4. order preserving compaction: count kept per chunk, write each chunk's survivors at its
+    //    offset in a side buffer, copy back
+    std::vector<size_t> kept(tasks + 1, 0);
+    for(unsigned t = 0; t < tasks; t++){
+        group.run([&, t]{
+            size_t c = 0;
+            for(size_t i = chunk_begin(t); i < chunk_begin(t + 1); i++) c += keep[i];
+            kept[t + 1] = c;
+        });
+    }
+    group.wait();
+    for(unsigned t = 0; t < tasks; t++) kept[t + 1] += kept[t];
+    std::vector<int> out(kept[tasks]);
+    for(unsigned t = 0; t < tasks; t++){
+        group.run([&, t]{
+            // stops at the last survivor so the unconditional write never lands in the next chunk
+            size_t o = kept[t];
+            for(size_t i = chunk_begin(t); o < kept[t + 1]; i++){
+                out[o] = a[i];
+                o += keep[i];
+            }
+        });
+    }
+    group.wait();
+    memcpy(a, out.data(), out.size() * sizeof(int));
+    return out.size();
+}
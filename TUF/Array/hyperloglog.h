@@ -0,0 +1,250 @@
+// approximate number of distinct values, in one pass over unsorted data and without a sort.
+//
+// every value is hashed to 64 bits; the top `precision` bits pick one of m = 2^precision byte
+// registers and the register keeps the longest run of leading zeros (+1) seen in the remaining bits.
+// the harmonic mean of 2^register over all registers estimates the count, with a relative
+// standard error of about 1.04 / sqrt(m): precision 14 is 16 KB and ~0.8%, precision 18 is 256 KB
+// and ~0.2%. small counts, where many registers are still 0, fall back to linear counting.
+//
+// sketches with the same precision merge by taking the larger register, so per-thread or per-file
+// sketches combine into exactly the sketch of all their input together.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "../thread_pool.h"
+
+const int HLL_MIN_PRECISION = 4;
+const int HLL_MAX_PRECISION = 18;
+const int HLL_DEFAULT_PRECISION = 14;
+// below this many values a parallel count is not worth the per-thread sketches
+const size_t PARALLEL_HLL_CUTOFF = 1 << 20;
+
+// murmur3 finalizer: every input bit affects every output bit
+inline uint64_t hll_hash(int x){
+    uint64_t h = (uint32_t)x;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline void hll_add_scalar(unsigned char* reg, int p, const int* a, size_t n){
+    // the marker bit caps the rank at 64 - p + 1 when the low bits are all zero
+    const uint64_t marker = 1ULL << (p - 1);
+    for(size_t i = 0; i < n; i++){
+        uint64_t h = hll_hash(a[i]);
+        unsigned char rank = __builtin_clzll((h << p) | marker) + 1;
+        unsigned char& r = reg[h >> (64 - p)];
+        if(rank > r) r = rank;
+    }
+}
+inline void hll_merge_scalar(unsigned char* into, const unsigned char* from, size_t m){
+    for(size_t i = 0; i < m; i++) into[i] = into[i] > from[i] ? into[i] : from[i];
+}
+// sum of 2^-reg[i] and the number of zero registers
+inline double hll_sum_scalar(const unsigned char* reg, size_t m, size_t& zeros){
+    double sum = 0;
+    zeros = 0;
+    for(size_t i = 0; i < m; i++){
+        sum += std::ldexp(1.0, -reg[i]);
+        zeros += reg[i] == 0;
+    }
+    return sum;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HLL_X86 1
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,popcnt"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+#endif
+namespace hll_avx2 {
+// m is a power of two >= 16
+inline void merge(unsigned char* into, const unsigned char* from, size_t m){
+    size_t i = 0;
+    for(; i + 32 <= m; i += 32){
+        __m256i a = _mm256_loadu_si256((const __m256i*)(into + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(from + i));
+        _mm256_storeu_si256((__m256i*)(into + i), _mm256_max_epu8(a, b));
+    }
+    hll_merge_scalar(into + i, from + i, m - i);
+}
+
+// 2^-r is built directly as a double: exponent field 1023 - r, mantissa 0
+inline double sum(const unsigned char* reg, size_t m, size_t& zeros){
+    __m256d acc = _mm256_setzero_pd();
+    const __m256i bias = _mm256_set1_epi64x(1023);
+    size_t zero_count = 0;
+    size_t i = 0;
+    for(; i + 32 <= m; i += 32){
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(reg + i));
+        zero_count += _mm_popcnt_u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_setzero_si256())));
+        for(int k = 0; k < 32; k += 4){
+            int32_t four;
+            memcpy(&four, reg + i + k, 4);
+            __m256i r = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(four));
+            __m256i bits = _mm256_slli_epi64(_mm256_sub_epi64(bias, r), 52);
+            acc = _mm256_add_pd(acc, _mm256_castsi256_pd(bits));
+        }
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    size_t tail_zeros;
+    double total = lanes[0] + lanes[1] + lanes[2] + lanes[3] + hll_sum_scalar(reg + i, m - i, tail_zeros);
+    zeros = zero_count + tail_zeros;
+    return total;
+}
+} // namespace hll_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx512dq,avx512cd"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512cd")
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+namespace hll_avx512 {
+const int W = 8;
+
+inline __m512i hash(__m512i h){
+    h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+    h = _mm512_mullo_epi64(h, _mm512_set1_epi64(0xFF51AFD7ED558CCDULL));
+    h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+    h = _mm512_mullo_epi64(h, _mm512_set1_epi64(0xC4CEB9FE1A85EC53ULL));
+    return _mm512_xor_si512(h, _mm512_srli_epi64(h, 33));
+}
+
+// hash, register index and rank for 8 values at a time in vector registers; only the final
+// max into the byte registers is scalar, since two lanes may hit the same register
+inline void add(unsigned char* reg, int p, const int* a, size_t n){
+    const __m512i marker = _mm512_set1_epi64(1ULL << (p - 1));
+    const __m512i one = _mm512_set1_epi64(1);
+    alignas(32) uint32_t index[W];
+    alignas(16) unsigned char rank[16];
+    size_t i = 0;
+    for(; i + W <= n; i += W){
+        __m512i h = hash(_mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)(a + i))));
+        __m512i w = _mm512_or_si512(_mm512_sll_epi64(h, _mm_cvtsi32_si128(p)), marker);
+        _mm256_store_si256((__m256i*)index, _mm512_cvtepi64_epi32(_mm512_srl_epi64(h, _mm_cvtsi32_si128(64 - p))));
+        _mm_store_si128((__m128i*)rank, _mm512_cvtepi64_epi8(_mm512_add_epi64(_mm512_lzcnt_epi64(w), one)));
+        for(int k = 0; k < W; k++){
+            unsigned char& r = reg[index[k]];
+            if(rank[k] > r) r = rank[k];
+        }
+    }
+    hll_add_scalar(reg, p, a + i, n - i);
+}
+} // namespace hll_avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+#endif // x86
+
+typedef void (*hll_add_fn)(unsigned char*, int, const int*, size_t);
+typedef void (*hll_merge_fn)(unsigned char*, const unsigned char*, size_t);
+typedef double (*hll_sum_fn)(const unsigned char*, size_t, size_t&);
+
+inline hll_add_fn pick_hll_add(){
+#ifdef HLL_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512cd")) return hll_avx512::add;
+#endif
+    return hll_add_scalar;
+}
+inline hll_merge_fn pick_hll_merge(){
+#ifdef HLL_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return hll_avx2::merge;
+#endif
+    return hll_merge_scalar;
+}
+inline hll_sum_fn pick_hll_sum(){
+#ifdef HLL_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return hll_avx2::sum;
+#endif
+    return hll_sum_scalar;
+}
+
+class hyperloglog {
+    int p;
+    std::vector<unsigned char> reg;
+
+public:
+    // precision is clamped to [HLL_MIN_PRECISION, HLL_MAX_PRECISION]
+    explicit hyperloglog(int precision = HLL_DEFAULT_PRECISION){
+        p = precision < HLL_MIN_PRECISION ? HLL_MIN_PRECISION : precision > HLL_MAX_PRECISION ? HLL_MAX_PRECISION : precision;
+        reg.assign((size_t)1 << p, 0);
+    }
+
+    int precision() const { return p; }
+    size_t bytes() const { return reg.size(); }
+    const unsigned char* registers() const { return reg.data(); }
+
+    void add(int x){ hll_add_scalar(reg.data(), p, &x, 1); }
+    void add(const int* a, size_t n){
+        static const hll_add_fn kernel = pick_hll_add();
+        kernel(reg.data(), p, a, n);
+    }
+
+    // false (and nothing merged) if the precisions differ
+    bool merge(const hyperloglog& other){
+        if(other.p != p) return false;
+        static const hll_merge_fn kernel = pick_hll_merge();
+        kernel(reg.data(), other.reg.data(), reg.size());
+        return true;
+    }
+
+    void clear(){ std::fill(reg.begin(), reg.end(), 0); }
+
+    double estimate() const {
+        static const hll_sum_fn kernel = pick_hll_sum();
+        double m = reg.size();
+        size_t zeros;
+        double sum = kernel(reg.data(), reg.size(), zeros);
+        double alpha = reg.size() == 16 ? 0.673 : reg.size() == 32 ? 0.697 : reg.size() == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+        double raw = alpha * m * m / sum;
+        // with 64 bit hashes there is no large range correction; only the small range one
+        if(raw <= 2.5 * m && zeros > 0) return m * std::log(m / zeros);
+        return raw;
+    }
+};
+
+// one sketch per task over its share of a, merged at the end
+inline hyperloglog parallel_hyperloglog(const int* a, size_t n, thread_pool& pool, int precision = HLL_DEFAULT_PRECISION){
+    hyperloglog total(precision);
+    unsigned tasks = pool.size();
+    if(n < PARALLEL_HLL_CUTOFF || tasks == 1){
+        total.add(a, n);
+        return total;
+    }
+    std::vector<hyperloglog> parts(tasks, hyperloglog(precision));
+    thread_pool::task_group group(pool);
+    for(unsigned t = 0; t < tasks; t++){
+        group.run([&, t]{
+            size_t begin = n * t / tasks, end = n * (t + 1) / tasks;
+            parts[t].add(a + begin, end - begin);
+        });
+    }
+    group.wait();
+    for(auto& part : parts) total.merge(part);
+    return total;
+}
@@ -1,10 +1,14 @@
 #include <iostream>
 #include <vector>
+#include "array_parallel.h"
+#include "mapped_file.h"
 using namespace std;
 
-int largest(vector<int>& arr){
+// pass a pool to split big arrays across its workers
+int largest(vector<int>& arr, thread_pool* pool = nullptr){
     int n = arr.size();
     if(n==0) return -1;
+    if(pool && arr.size() >= PARALLEL_SCAN_CUTOFF) return parallel_array_scan(arr.data(), n, *pool).max;
     int max = arr[0];
     for(int num : arr){
         if(num > max){
@@ -13,8 +17,19 @@ int largest(vector<int>& arr){
     }
     return max;
 }
+// same over a span, e.g. a mapped file
+int largest(int_span arr, thread_pool* pool = nullptr){
+    if(arr.empty()) return -1;
+    return pool ? parallel_array_scan(arr.data(), arr.size(), *pool).max : array_scan(arr.data(), arr.size()).max;
+}
 
-int main(){
+// ./largest [file.bin]   with a file, its int32 contents are mapped instead of using the sample
+int main(int argc, char** argv){
+    if(argc > 1){
+        mapped_file file(argv[1]);
+        cout << largest(file.span(), &default_pool());
+        return 0;
+    }
     vector<int> arr = {3, 5, 1, 8, 2};
     cout << largest(arr);
     return 0;
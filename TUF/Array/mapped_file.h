@@ -0,0 +1,151 @@
+// binary int32 files as arrays without loading them: mapped_file maps the file and hands out an
+// int_span over the mapping, which the TUF/Array functions accept next to vector<int>. pages are
+// read by the kernel on demand, and madvise tells it to read ahead and drop pages behind the scan.
+//
+// pipes and stdin cannot be mapped, so for_each_int_chunk reads them a fixed size block at a time;
+// callers carry whatever state they need between blocks (see scan_merger in array_scan.h).
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// a view of n ints that it does not own: a mapped file, part of a vector, ...
+struct int_span {
+    int* ptr = nullptr;
+    size_t len = 0;
+
+    int_span() {}
+    int_span(int* p, size_t n) : ptr(p), len(n) {}
+    int_span(std::vector<int>& v) : ptr(v.data()), len(v.size()) {}
+
+    int* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    int* begin() const { return ptr; }
+    int* end() const { return ptr + len; }
+    int& operator[](size_t i) const { return ptr[i]; }
+};
+
+// write_back = false: the file is opened read only and mapped copy-on-write, so code may modify
+// the span but the changes stay private to this process. write_back = true: the mapping is shared
+// and changes land in the file. a trailing partial int is ignored.
+class mapped_file {
+    void* base = nullptr;
+    size_t bytes = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+public:
+    explicit mapped_file(const std::string& path, bool write_back = false){
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), write_back ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ,
+                           nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER size;
+        if(file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)){
+            std::cerr << "cannot open " << path << std::endl;
+            exit(1);
+        }
+        bytes = size.QuadPart;
+        if(bytes == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, write_back ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, nullptr);
+        if(mapping) base = MapViewOfFile(mapping, write_back ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, 0);
+        if(!base){
+            std::cerr << "cannot map " << path << std::endl;
+            exit(1);
+        }
+#else
+        fd = open(path.c_str(), write_back ? O_RDWR : O_RDONLY);
+        struct stat st;
+        if(fd < 0 || fstat(fd, &st) != 0){
+            std::cerr << "cannot open " << path << std::endl;
+            exit(1);
+        }
+        bytes = st.st_size;
+        if(bytes == 0) return; // mmap refuses empty mappings
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, write_back ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+        if(base == MAP_FAILED){
+            std::cerr << "cannot map " << path << std::endl;
+            exit(1);
+        }
+#if defined(MADV_SEQUENTIAL)
+        madvise(base, bytes, MADV_SEQUENTIAL);
+#endif
+#if defined(MADV_HUGEPAGE)
+        madvise(base, bytes, MADV_HUGEPAGE); // only honoured where the kernel supports file THP
+#endif
+#endif
+    }
+
+    ~mapped_file(){
+#if defined(_WIN32)
+        if(base) UnmapViewOfFile(base);
+        if(mapping) CloseHandle(mapping);
+        if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if(base) munmap(base, bytes);
+        if(fd >= 0) close(fd);
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    int* data() const { return static_cast<int*>(base); }
+    size_t size() const { return bytes / sizeof(int); }
+    size_t trailing_bytes() const { return bytes % sizeof(int); } // the partial int size() leaves out
+    int_span span() const { return int_span(data(), size()); }
+};
+
+// cuts a file down to its first n ints, e.g. after compacting it in place through a shared mapping
+inline bool truncate_ints(const std::string& path, size_t n){
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    size.QuadPart = n * sizeof(int);
+    bool ok = SetFilePointerEx(file, size, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+    return ok;
+#else
+    return truncate(path.c_str(), n * sizeof(int)) == 0;
+#endif
+}
+
+// reads ints from a stream in blocks of chunk_ints and calls f(const int* block, size_t n) for each.
+// a read can end in the middle of an int on a pipe; those bytes are kept for the next block.
+// returns false if the stream ended with a partial int.
+template <class F>
+bool for_each_int_chunk(FILE* in, size_t chunk_ints, F f){
+    std::vector<int> block(chunk_ints);
+    char* buf = reinterpret_cast<char*>(block.data());
+    size_t capacity = chunk_ints * sizeof(int);
+    size_t filled = 0;
+    while(true){
+        size_t got = fread(buf + filled, 1, capacity - filled, in);
+        filled += got;
+        size_t whole = filled / sizeof(int);
+        if(whole > 0 && (filled == capacity || got == 0)){
+            f(block.data(), whole);
+            size_t rest = filled - whole * sizeof(int);
+            memmove(buf, buf + whole * sizeof(int), rest);
+            filled = rest;
+        }
+        if(got == 0) return filled == 0;
+    }
+}
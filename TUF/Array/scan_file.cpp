@@ -0,0 +1,123 @@
+// largest, second largest, min and sortedness of a binary int32 file in one pass, without loading it
+//
+//   g++ -O2 -std=c++17 -pthread scan_file.cpp -o scan_file
+//   ./scan_file <file.bin | -> [--chunk-mb 4] [--dedup out.bin]
+//
+// a regular file is mapped and scanned in parallel. "-" (or any pipe) is read from stdin one chunk
+// at a time, carrying the running result from chunk to chunk, so memory stays at one chunk.
+// --dedup also writes the input with adjacent duplicates removed (all duplicates for sorted input).
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "array_parallel.h"
+#include "dedup.h"
+#include "mapped_file.h"
+using namespace std;
+
+// a short write or a failed close means a full disk or an I/O error: stop instead of reporting a
+// truncated output as written
+[[noreturn]] void fail(const string& what, const string& path){
+    cerr << what << " " << path << ": " << strerror(errno) << endl;
+    exit(1);
+}
+
+// deduplicates block after block, remembering the last value written so a run of equal values
+// that crosses a block edge is still written once
+class dedup_writer {
+    FILE* out;
+    string path;
+    vector<int> buffer;
+    bool any = false;
+    int last = 0;
+
+public:
+    dedup_writer(FILE* f, const string& p, size_t chunk_ints) : out(f), path(p), buffer(chunk_ints) {}
+    unsigned long long written = 0;
+
+    void add(const int* a, size_t n){
+        for(size_t done = 0; done < n; done += buffer.size()){
+            size_t len = min(buffer.size(), n - done);
+            memcpy(buffer.data(), a + done, len * sizeof(int));
+            size_t kept = dedup_sorted(buffer.data(), len);
+            size_t skip = any && buffer[0] == last;
+            if(fwrite(buffer.data() + skip, sizeof(int), kept - skip, out) != kept - skip) fail("write failed on", path);
+            written += kept - skip;
+            last = buffer[kept - 1];
+            any = true;
+        }
+    }
+};
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        cerr << "usage: " << argv[0] << " <file.bin | -> [--chunk-mb 4] [--dedup out.bin]" << endl;
+        return 1;
+    }
+    string input = argv[1];
+    size_t chunk_ints = (4u << 20) / sizeof(int);
+    string dedup_path;
+    for(int i = 2; i + 1 < argc; i += 2){
+        string flag = argv[i];
+        if(flag == "--chunk-mb") chunk_ints = max<size_t>(strtoull(argv[i + 1], nullptr, 10), 1) << 20 >> 2;
+        else if(flag == "--dedup") dedup_path = argv[i + 1];
+        else {
+            cerr << "unknown flag " << flag << endl;
+            return 1;
+        }
+    }
+
+    FILE* dedup_out = nullptr;
+    if(!dedup_path.empty() && !(dedup_out = fopen(dedup_path.c_str(), "wb"))){
+        cerr << "cannot create " << dedup_path << endl;
+        return 1;
+    }
+    dedup_writer writer(dedup_out, dedup_path, chunk_ints);
+
+    auto start = chrono::steady_clock::now();
+    array_scan_result r;
+    bool streamed = input == "-";
+    bool whole = true; // false when the input ends inside an int
+#if !defined(_WIN32)
+    struct stat st;
+    if(!streamed && stat(input.c_str(), &st) == 0 && !S_ISREG(st.st_mode)) streamed = true; // fifo, device
+#endif
+    if(streamed){
+        FILE* in = input == "-" ? stdin : fopen(input.c_str(), "rb");
+        if(!in){
+            cerr << "cannot open " << input << endl;
+            return 1;
+        }
+        scan_merger merged;
+        whole = for_each_int_chunk(in, chunk_ints, [&](const int* block, size_t n){
+            merged.add(block, n);
+            if(dedup_out) writer.add(block, n);
+        });
+        r = merged.result();
+    } else {
+        mapped_file file(input);
+        r = parallel_array_scan(file.data(), file.size(), default_pool());
+        if(dedup_out) writer.add(file.data(), file.size());
+        whole = file.trailing_bytes() == 0;
+    }
+    if(!whole) cerr << "warning: input ended inside an int, last bytes ignored" << endl;
+    if(dedup_out && fclose(dedup_out) != 0) fail("write failed on", dedup_path);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if(r.max < r.min){
+        cout << "empty input" << endl;
+        return 0;
+    }
+    cout << "largest " << r.max << endl;
+    cout << "second largest " << (r.has_second ? to_string(r.second_max) : "none") << endl;
+    cout << "smallest " << r.min << endl;
+    if(r.sorted) cout << "sorted, " << r.first_unsorted << " ints" << endl; // first_unsorted is n when sorted
+    else cout << "not sorted, first out of order at index " << r.first_unsorted << endl;
+    if(dedup_out) cout << "wrote " << writer.written << " ints to " << dedup_path << endl;
+    cerr << seconds << " s" << endl;
+    return 0;
+}
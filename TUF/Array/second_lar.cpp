@@ -1,9 +1,16 @@
 #include <iostream>
 #include <vector>
+#include "array_parallel.h"
+#include "mapped_file.h"
 using namespace std;
 
-int secondLargestElement(vector<int>& arr) {
+// pass a pool to split big arrays across its workers
+int secondLargestElement(vector<int>& arr, thread_pool* pool = nullptr) {
         if (arr.size() < 2) return -1; 
+        if (pool && arr.size() >= PARALLEL_SCAN_CUTOFF) {
+            array_scan_result r = parallel_array_scan(arr.data(), arr.size(), *pool);
+            return (!r.has_second || r.second_max == INT_MIN) ? -1 : r.second_max;
+        }
         int max = INT_MIN;
         int sm = INT_MIN;
         for(int val : arr){
@@ -17,8 +24,20 @@ int secondLargestElement(vector<int>& arr) {
         }
          return (sm == INT_MIN) ? -1 : sm;
     }
+// same over a span, e.g. a mapped file
+int secondLargestElement(int_span arr, thread_pool* pool = nullptr) {
+        if (arr.size() < 2) return -1;
+        array_scan_result r = pool ? parallel_array_scan(arr.data(), arr.size(), *pool) : array_scan(arr.data(), arr.size());
+        return (!r.has_second || r.second_max == INT_MIN) ? -1 : r.second_max;
+    }
 
-int main(){
+// ./second_lar [file.bin]   with a file, its int32 contents are mapped instead of using the sample
+int main(int argc, char** argv){
+    if(argc > 1){
+        mapped_file file(argv[1]);
+        cout << secondLargestElement(file.span(), &default_pool());
+        return 0;
+    }
     vector<int> arr = {3, 5, 1, 8, 2};
     cout << secondLargestElement(arr);
     return 0;
@@ -0,0 +1,65 @@
+// check_sorted / largest / remove_dublicate / sort over many small arrays in one flat buffer
+//
+//   g++ -O2 -std=c++17 -pthread segmented.cpp -o segmented
+//   ./segmented [segments]   also times a million-scale batch against one vector per array
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "segmented.h"
+using namespace std;
+
+int main(int argc, char** argv){
+    // three sessions: {1, 2, 2, 3}, {}, {9, 4, 4}
+    vector<int> values = {1, 2, 2, 3, 9, 4, 4};
+    vector<size_t> offsets = {0, 4, 4, 7};
+    size_t segs = offsets.size() - 1;
+    vector<unsigned char> sorted(segs);
+    vector<int> largest(segs);
+    segmented_check_sorted(values.data(), offsets.data(), segs, sorted.data());
+    segmented_largest(values.data(), offsets.data(), segs, largest.data());
+    segmented_sort(values.data(), offsets.data(), segs);
+    vector<size_t> new_offsets(segs + 1);
+    segmented_remove_dublicate(values.data(), offsets.data(), segs, values.data(), new_offsets.data());
+    for(size_t s = 0; s < segs; s++){
+        cout << "segment " << s << ": sorted " << (int)sorted[s] << ", largest " << largest[s] << ", deduplicated {";
+        for(size_t k = new_offsets[s]; k < new_offsets[s + 1]; k++) cout << (k > new_offsets[s] ? " " : "") << values[k];
+        cout << "}" << endl;
+    }
+
+    if(argc < 2) return 0;
+    size_t count = strtoull(argv[1], nullptr, 10);
+    mt19937 rng(16);
+    vector<vector<int>> separate(count);
+    offsets.assign(1, 0);
+    values.clear();
+    for(auto& v : separate){
+        v.resize(rng() % 16);
+        for(int& x : v) x = rng() % 100;
+        values.insert(values.end(), v.begin(), v.end());
+        offsets.push_back(values.size());
+    }
+    segs = count;
+    sorted.resize(segs);
+    largest.resize(segs);
+    thread_pool& pool = default_pool();
+
+    auto start = chrono::steady_clock::now();
+    for(auto& v : separate){
+        sort(v.begin(), v.end());
+        v.erase(unique(v.begin(), v.end()), v.end());
+    }
+    double one_by_one = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    segmented_check_sorted(values.data(), offsets.data(), segs, sorted.data(), &pool);
+    segmented_largest(values.data(), offsets.data(), segs, largest.data(), &pool);
+    segmented_sort(values.data(), offsets.data(), segs, &pool);
+    new_offsets.resize(segs + 1);
+    size_t total = segmented_remove_dublicate(values.data(), offsets.data(), segs, values.data(), new_offsets.data(), &pool);
+    double batched = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << count << " arrays: sort + dedup one vector at a time " << one_by_one * 1e3 << " ms, batched check + max + sort + dedup "
+         << batched * 1e3 << " ms, " << total << " values left" << endl;
+    return 0;
+}
@@ -0,0 +1,308 @@
+// check_sorted / largest / remove_dublicate / sort over many small arrays stored back to back
+// (CSR layout): one flat values buffer, and offsets[s] .. offsets[s + 1] is segment s, so there are
+// segs + 1 offsets. results go to flat arrays indexed by segment.
+//
+// the kernels walk the flat buffer a vector at a time without caring where segments start, and
+// keep a cursor into offsets to attribute each lane to its segment. for max this is a segmented
+// scan: a lane that starts a segment blocks the running max coming from the lanes before it.
+// with a pool, segment ranges holding about the same number of elements go to different workers.
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include "../sort_generic.h"
+#include "../thread_pool.h"
+#include "dedup.h"
+
+// below this many elements the segments are processed on the calling thread
+const size_t SEGMENTED_PARALLEL_CUTOFF = 1 << 16;
+// segments at least this long are sorted one at a time with the whole pool
+const size_t SEGMENT_PARALLEL_SORT_MIN = 1 << 20;
+// parallel_merge_sort takes int bounds; longer segments stay with the generic quick_sort
+const size_t SEGMENT_PARALLEL_SORT_MAX = INT_MAX;
+
+// splits segments [0, segs) into `parts` ranges with about equal element counts;
+// range t is [bounds[t], bounds[t + 1])
+inline std::vector<size_t> segment_ranges(const size_t* offsets, size_t segs, unsigned parts){
+    std::vector<size_t> bounds(parts + 1, segs);
+    bounds[0] = 0;
+    size_t total = offsets[segs] - offsets[0];
+    for(unsigned t = 1; t < parts; t++){
+        size_t target = offsets[0] + total / parts * t;
+        bounds[t] = std::upper_bound(offsets, offsets + segs + 1, target) - offsets - 1;
+        bounds[t] = std::max(bounds[t], bounds[t - 1]);
+    }
+    return bounds;
+}
+
+// runs f(first_segment, end_segment) over ranges of segments, on the pool when it is worth it
+template <class F>
+void for_each_segment_range(const size_t* offsets, size_t segs, thread_pool* pool, F f){
+    if(!pool || pool->size() == 1 || offsets[segs] - offsets[0] < SEGMENTED_PARALLEL_CUTOFF){
+        f(0, segs);
+        return;
+    }
+    std::vector<size_t> bounds = segment_ranges(offsets, segs, pool->size());
+    thread_pool::task_group group(*pool);
+    for(unsigned t = 0; t < pool->size(); t++){
+        size_t s0 = bounds[t], s1 = bounds[t + 1];
+        if(s0 < s1) group.run([=, &f]{ f(s0, s1); });
+    }
+    group.wait();
+}
+
+// ---- scalar kernels, also used for the tail after the vector loop ----
+// each takes the segment range [s0, s1) and, for the tail, the flat index i the vector loop reached
+
+// sorted[s] = 1 if segment s is non-decreasing
+inline void segmented_sorted_scalar(const int* a, const size_t* offsets, size_t s0, size_t s1, unsigned char* sorted, size_t i){
+    for(size_t s = s0; s < s1; s++){
+        size_t from = std::max(offsets[s] + 1, i);
+        size_t to = offsets[s + 1];
+        bool ok = true;
+        for(size_t k = from; k < to && ok; k++) ok = a[k] >= a[k - 1];
+        sorted[s] &= ok;
+    }
+}
+// largest[s] = max of segment s, -1 when it is empty. carried is the running max of the part of
+// segment s0 before i.
+inline void segmented_max_scalar(const int* a, const size_t* offsets, size_t s0, size_t s1, int* largest, size_t i, int carried){
+    for(size_t s = s0; s < s1; s++){
+        size_t from = offsets[s], to = offsets[s + 1];
+        if(from == to){
+            largest[s] = -1;
+            continue;
+        }
+        int m = from < i ? carried : INT_MIN;
+        for(size_t k = std::max(from, i); k < to; k++) m = std::max(m, a[k]);
+        largest[s] = m;
+    }
+}
+// copies segment elements that differ from their left neighbour in the same segment to out[o..),
+// recording where each segment ends. prev is a[i - 1] as it was before any writes.
+inline size_t segmented_dedup_scalar(const int* a, const size_t* offsets, size_t s0, size_t s1, int* out, size_t* out_offsets,
+                                     size_t i, size_t o, int prev){
+    for(size_t s = s0; s < s1; s++){
+        size_t from = offsets[s], to = offsets[s + 1];
+        for(size_t k = std::max(from, i); k < to; k++){
+            int x = a[k];
+            out[o] = x;
+            o += k == from || x != prev;
+            prev = x;
+        }
+        out_offsets[s + 1] = o;
+    }
+    return o;
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SEGMENTED_X86 1
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,popcnt"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+#endif
+namespace segmented_avx2 {
+const int W = 8;
+
+// lanes moved D places up, the lowest D lanes filled with fill
+template <int D>
+inline __m256i shift_up(__m256i v, __m256i fill){
+    const __m256i index = _mm256_setr_epi32(0 - D < 0 ? 0 : 0 - D, 1 - D < 0 ? 0 : 1 - D, 2 - D < 0 ? 0 : 2 - D, 3 - D < 0 ? 0 : 3 - D,
+                                            4 - D, 5 - D, 6 - D, 7 - D);
+    return _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, index), fill, (1 << D) - 1);
+}
+// one bit per lane of the block starting at i for every non-empty segment that starts there
+inline unsigned head_bits(const size_t* offsets, size_t s1, size_t& head, size_t i){
+    unsigned bits = 0;
+    for(; head < s1 && offsets[head] < i + W; head++){
+        if(offsets[head] < offsets[head + 1]) bits |= 1u << (offsets[head] - i);
+    }
+    return bits;
+}
+inline __m256i bits_to_lanes(unsigned bits){
+    const __m256i lane_bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), lane_bit), lane_bit);
+}
+
+inline void check_sorted(const int* a, const size_t* offsets, size_t s0, size_t s1, unsigned char* sorted){
+    std::fill(sorted + s0, sorted + s1, 1);
+    size_t begin = offsets[s0], end = offsets[s1];
+    size_t seg = s0;
+    size_t skip_until = begin; // descents before this are in a segment already known unsorted
+    size_t i = begin + 1;
+    for(; i + W <= end; i += W){
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i prev = _mm256_loadu_si256((const __m256i*)(a + i - 1));
+        unsigned descents = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(prev, v)));
+        while(descents){
+            size_t p = i + __builtin_ctz(descents);
+            descents &= descents - 1;
+            if(p < skip_until) continue;
+            while(offsets[seg + 1] <= p) seg++;
+            if(p != offsets[seg]){ // a drop across a segment start does not count
+                sorted[seg] = 0;
+                skip_until = offsets[seg + 1];
+            }
+        }
+    }
+    while(seg < s1 && offsets[seg + 1] <= i) seg++;
+    if(seg < s1) segmented_sorted_scalar(a, offsets, seg, s1, sorted, i);
+}
+
+inline void largest(const int* a, const size_t* offsets, size_t s0, size_t s1, int* out){
+    const __m256i minus_inf = _mm256_set1_epi32(INT_MIN);
+    const __m256i none = _mm256_setzero_si256();
+    size_t begin = offsets[s0], end = offsets[s1];
+    size_t head = s0, done = s0;
+    __m256i carry = minus_inf;
+    alignas(32) int scanned[W];
+    size_t i = begin;
+    for(; i + W <= end; i += W){
+        __m256i flag = bits_to_lanes(head_bits(offsets, s1, head, i));
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        // running max inside the vector that stops at segment heads (log2(W) steps)
+        v = _mm256_blendv_epi8(_mm256_max_epi32(v, shift_up<1>(v, minus_inf)), v, flag);
+        flag = _mm256_or_si256(flag, shift_up<1>(flag, none));
+        v = _mm256_blendv_epi8(_mm256_max_epi32(v, shift_up<2>(v, minus_inf)), v, flag);
+        flag = _mm256_or_si256(flag, shift_up<2>(flag, none));
+        v = _mm256_blendv_epi8(_mm256_max_epi32(v, shift_up<4>(v, minus_inf)), v, flag);
+        flag = _mm256_or_si256(flag, shift_up<4>(flag, none));
+        // lanes before the first head continue the segment from the previous vector
+        v = _mm256_blendv_epi8(_mm256_max_epi32(v, carry), v, flag);
+        _mm256_store_si256((__m256i*)scanned, v);
+        for(; done < s1 && offsets[done + 1] <= i + W; done++){
+            size_t last = offsets[done + 1];
+            out[done] = last == offsets[done] ? -1 : scanned[last - 1 - i];
+        }
+        carry = _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(W - 1));
+    }
+    if(done < s1) segmented_max_scalar(a, offsets, done, s1, out, i, _mm256_extract_epi32(carry, 0));
+}
+
+inline size_t dedup(const int* a, const size_t* offsets, size_t s0, size_t s1, int* out, size_t* out_offsets, size_t o){
+    static const dedup_avx2::compress_table table;
+    size_t begin = offsets[s0], end = offsets[s1];
+    size_t head = s0, done = s0;
+    __m256i carry = _mm256_setzero_si256();
+    size_t i = begin;
+    for(; i + W <= end; i += W){
+        unsigned heads = head_bits(offsets, s1, head, i);
+        __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i prev = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6)), carry, 0x01);
+        unsigned keep = (~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, prev))) | heads) & 0xFF;
+        for(; done < s1 && offsets[done + 1] <= i + W; done++){
+            unsigned lanes = offsets[done + 1] - i; // lanes of this block that belong to segments up to done
+            out_offsets[done + 1] = o + _mm_popcnt_u32(keep & ((1u << lanes) - 1));
+        }
+        __m256i order = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(table.lanes[keep]));
+        _mm256_storeu_si256((__m256i*)(out + o), _mm256_permutevar8x32_epi32(v, order));
+        o += _mm_popcnt_u32(keep);
+        carry = _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(7));
+    }
+    if(done < s1) o = segmented_dedup_scalar(a, offsets, done, s1, out, out_offsets, i, o, i > begin ? _mm256_extract_epi32(carry, 0) : 0);
+    return o;
+}
+} // namespace segmented_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // x86
+
+inline bool segmented_use_avx2(){
+#ifdef SEGMENTED_X86
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+// sorted[s] = 1 if segment s is non-decreasing (empty and single element segments are)
+inline void segmented_check_sorted(const int* values, const size_t* offsets, size_t segs, unsigned char* sorted,
+                                   thread_pool* pool = nullptr){
+    for_each_segment_range(offsets, segs, pool, [&](size_t s0, size_t s1){
+#ifdef SEGMENTED_X86
+        if(segmented_use_avx2()) return segmented_avx2::check_sorted(values, offsets, s0, s1, sorted);
+#endif
+        std::fill(sorted + s0, sorted + s1, 1);
+        segmented_sorted_scalar(values, offsets, s0, s1, sorted, 0);
+    });
+}
+
+// largest[s] = max of segment s, -1 for an empty segment (like largest())
+inline void segmented_largest(const int* values, const size_t* offsets, size_t segs, int* largest, thread_pool* pool = nullptr){
+    for_each_segment_range(offsets, segs, pool, [&](size_t s0, size_t s1){
+#ifdef SEGMENTED_X86
+        if(segmented_use_avx2()) return segmented_avx2::largest(values, offsets, s0, s1, largest);
+#endif
+        segmented_max_scalar(values, offsets, s0, s1, largest, 0, INT_MIN);
+    });
+}
+
+// removes duplicates from every (sorted) segment. the survivors are packed into out with new
+// offsets in out_offsets (segs + 1 entries); out may be values itself. returns the new total.
+inline size_t segmented_remove_dublicate(const int* values, const size_t* offsets, size_t segs, int* out, size_t* out_offsets,
+                                         thread_pool* pool = nullptr){
+    auto run = [&](size_t s0, size_t s1, size_t o){
+#ifdef SEGMENTED_X86
+        if(segmented_use_avx2()) return segmented_avx2::dedup(values, offsets, s0, s1, out, out_offsets, o);
+#endif
+        return segmented_dedup_scalar(values, offsets, s0, s1, out, out_offsets, offsets[s0], o, 0);
+    };
+    out_offsets[0] = offsets[0];
+    if(!pool || pool->size() == 1 || offsets[segs] - offsets[0] < SEGMENTED_PARALLEL_CUTOFF) return run(0, segs, offsets[0]) - offsets[0];
+
+    // each range compacts into the space its own input occupied, then the ranges are slid together
+    std::vector<size_t> bounds = segment_ranges(offsets, segs, pool->size());
+    std::vector<size_t> ends(pool->size());
+    {
+        thread_pool::task_group group(*pool);
+        for(unsigned t = 0; t < pool->size(); t++){
+            size_t s0 = bounds[t], s1 = bounds[t + 1];
+            ends[t] = offsets[s0];
+            if(s0 < s1) group.run([&, t, s0, s1]{ ends[t] = run(s0, s1, offsets[s0]); });
+        }
+    }
+    size_t o = offsets[0];
+    for(unsigned t = 0; t < pool->size(); t++){
+        size_t s0 = bounds[t], s1 = bounds[t + 1];
+        size_t from = offsets[s0];
+        memmove(out + o, out + from, (ends[t] - from) * sizeof(int));
+        for(size_t s = s0 + 1; s <= s1; s++) out_offsets[s] -= from - o;
+        o += ends[t] - from;
+    }
+    return o - offsets[0];
+}
+
+// sorts every segment in place with the sort.h engines: sorting networks for short segments,
+// quick_sort for the rest, and parallel_merge_sort over the whole pool for very long ones (up to
+// SEGMENT_PARALLEL_SORT_MAX elements)
+inline void segmented_sort(int* values, const size_t* offsets, size_t segs, thread_pool* pool = nullptr){
+    bool split_long = pool && pool->size() > 1;
+    auto whole_pool = [&](size_t len){ return len >= SEGMENT_PARALLEL_SORT_MIN && len <= SEGMENT_PARALLEL_SORT_MAX; };
+    for_each_segment_range(offsets, segs, pool, [&](size_t s0, size_t s1){
+        for(size_t s = s0; s < s1; s++){
+            size_t len = offsets[s + 1] - offsets[s];
+            if(len <= (size_t)NETWORK_SORT_MAX){
+                if(len > 1) small_sort(values + offsets[s], len);
+            } else if(!split_long || !whole_pool(len)){
+                quick_sort(values + offsets[s], values + offsets[s + 1]);
+            }
+        }
+    });
+    if(!split_long) return;
+    std::vector<int> scratch;
+    for(size_t s = 0; s < segs; s++){
+        size_t len = offsets[s + 1] - offsets[s];
+        if(!whole_pool(len)) continue;
+        scratch.resize(len);
+        parallel_merge_sort(values + offsets[s], scratch.data(), 0, (int)(len - 1), false, *pool);
+    }
+}
@@ -0,0 +1,68 @@
+// intersection / union / difference of two deduplicated arrays
+//
+//   g++ -O2 -std=c++17 sorted_set.cpp -o sorted_set
+//   ./sorted_set [n]   also times the set operations against std:: on two random sets of n
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "sorted_set.h"
+using namespace std;
+
+void print(const char* name, const vector<int>& out, size_t n){
+    cout << name << ":";
+    for(size_t i = 0; i < n; i++) cout << " " << out[i];
+    cout << endl;
+}
+
+// up to n distinct sorted values out of [0, range)
+vector<int> random_set(size_t n, size_t range, mt19937& rng){
+    vector<int> v(n);
+    for(int& x : v) x = rng() % range;
+    sort(v.begin(), v.end());
+    v.resize(dedup_sorted(v.data(), v.size()));
+    return v;
+}
+
+int main(int argc, char** argv){
+    vector<int> a = {1, 3, 4, 7, 9, 12};
+    vector<int> b = {3, 5, 7, 8, 12, 15};
+    vector<int> out(a.size() + b.size());
+    print("intersection", out, set_intersection(a.data(), a.size(), b.data(), b.size(), out.data()));
+    print("union", out, set_union(a.data(), a.size(), b.data(), b.size(), out.data()));
+    print("difference", out, set_difference(a.data(), a.size(), b.data(), b.size(), out.data()));
+    cout << "intersection count: " << set_intersection_count(a.data(), a.size(), b.data(), b.size()) << endl;
+
+    if(argc < 2) return 0;
+    size_t n = strtoull(argv[1], nullptr, 10);
+    mt19937 rng(17);
+    a = random_set(n, 4 * n, rng);
+    b = random_set(n, 4 * n, rng);
+    vector<int> small = random_set(n / 1000 + 1, 4 * n, rng);
+    out.resize(a.size() + b.size());
+    auto time = [](auto f){
+        auto start = chrono::steady_clock::now();
+        f();
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    vector<int> expected;
+    double ours = time([&]{ set_intersection(a.data(), a.size(), b.data(), b.size(), out.data()); });
+    double stl = time([&]{ std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected)); });
+    cout << "intersection of " << a.size() << " and " << b.size() << ": " << ours << " ms, std " << stl << " ms" << endl;
+    expected.clear();
+    ours = time([&]{ set_union(a.data(), a.size(), b.data(), b.size(), out.data()); });
+    stl = time([&]{ std::set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected)); });
+    cout << "union: " << ours << " ms, std " << stl << " ms" << endl;
+    expected.clear();
+    ours = time([&]{ set_difference(a.data(), a.size(), b.data(), b.size(), out.data()); });
+    stl = time([&]{ std::set_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected)); });
+    cout << "difference: " << ours << " ms, std " << stl << " ms" << endl;
+    expected.clear();
+    ours = time([&]{ set_intersection(small.data(), small.size(), a.data(), a.size(), out.data()); });
+    stl = time([&]{ std::set_intersection(small.begin(), small.end(), a.begin(), a.end(), back_inserter(expected)); });
+    cout << "intersection of " << small.size() << " and " << a.size() << " (galloping): " << ours << " ms, std " << stl << " ms" << endl;
+    return 0;
+}
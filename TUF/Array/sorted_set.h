@@ -0,0 +1,308 @@
+// intersection, union, difference and intersection count of sorted arrays without duplicates
+// (e.g. the output of remove_dublicate). results are written to a buffer the caller provides and
+// the functions return how many ints they wrote, so nothing is allocated:
+//   intersection  needs min(na, nb) ints      union       needs na + nb
+//   difference    needs na (a without b)
+//
+// inputs of similar size are merged: with AVX2 a block of 8 from each side is compared all
+// against all (the b block rotated through every lane), and the side whose block ends lower moves
+// on. union merges blocks of 8 with a bitonic network instead and drops the second copy of a value
+// found on both sides. when one side is more than SET_GALLOP_RATIO times the other, every element
+// of the small side is looked up in the large one by exponential search from where the last lookup
+// ended instead.
+#pragma once
+#include <algorithm>
+#include "dedup.h"
+
+const size_t SET_GALLOP_RATIO = 32;
+
+// first k >= from with arr[k] >= x, or n: probes from+1, from+3, from+7, ... then binary search
+inline size_t gallop_lower(const int* arr, size_t n, size_t from, int x){
+    size_t step = 1, lo = from, hi = from;
+    while(hi < n && arr[hi] < x){
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    return std::lower_bound(arr + lo, arr + std::min(hi, n), x) - arr;
+}
+inline bool set_skewed(size_t na, size_t nb){
+    return std::max(na, nb) / SET_GALLOP_RATIO > std::min(na, nb);
+}
+
+// ---- branchless merges ----
+// every step writes a candidate and moves the output cursor by a 0/1 flag instead of branching
+inline size_t set_intersection_scalar(const int* a, size_t na, const int* b, size_t nb, int* out, size_t i = 0, size_t j = 0){
+    size_t o = 0;
+    while(i < na && j < nb){
+        int x = a[i], y = b[j];
+        out[o] = x;
+        o += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return o;
+}
+inline size_t set_intersection_count_scalar(const int* a, size_t na, const int* b, size_t nb, size_t i = 0, size_t j = 0){
+    size_t count = 0;
+    while(i < na && j < nb){
+        int x = a[i], y = b[j];
+        count += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return count;
+}
+inline size_t set_difference_scalar(const int* a, size_t na, const int* b, size_t nb, int* out, size_t i = 0, size_t j = 0){
+    size_t o = 0;
+    while(i < na && j < nb){
+        int x = a[i], y = b[j];
+        out[o] = x;
+        o += x < y;
+        i += x <= y;
+        j += y <= x;
+    }
+    std::copy(a + i, a + na, out + o);
+    return o + na - i;
+}
+inline size_t set_union_scalar(const int* a, size_t na, const int* b, size_t nb, int* out){
+    size_t i = 0, j = 0, o = 0;
+    while(i < na && j < nb){
+        int x = a[i], y = b[j];
+        out[o++] = x < y ? x : y;
+        i += x <= y;
+        j += y <= x;
+    }
+    std::copy(a + i, a + na, out + o);
+    o += na - i;
+    std::copy(b + j, b + nb, out + o);
+    return o + nb - j;
+}
+
+// ---- galloping, for very different sizes ----
+inline size_t set_intersection_gallop(const int* small, size_t ns, const int* large, size_t nl, int* out){
+    size_t o = 0, pos = 0;
+    for(size_t i = 0; i < ns && pos < nl; i++){
+        pos = gallop_lower(large, nl, pos, small[i]);
+        if(pos < nl && large[pos] == small[i]) out[o++] = small[i];
+    }
+    return o;
+}
+inline size_t set_difference_gallop(const int* a, size_t na, const int* b, size_t nb, int* out){
+    size_t o = 0, pos = 0;
+    if(na <= nb){ // look each a up in b
+        for(size_t i = 0; i < na; i++){
+            pos = gallop_lower(b, nb, pos, a[i]);
+            if(pos == nb || b[pos] != a[i]) out[o++] = a[i];
+        }
+        return o;
+    }
+    // look each b up in a and copy the stretches of a in between
+    for(size_t j = 0; j < nb && pos < na; j++){
+        size_t k = gallop_lower(a, na, pos, b[j]);
+        std::copy(a + pos, a + k, out + o);
+        o += k - pos;
+        pos = k + (k < na && a[k] == b[j]);
+    }
+    std::copy(a + pos, a + na, out + o);
+    return o + na - pos;
+}
+inline size_t set_union_gallop(const int* small, size_t ns, const int* large, size_t nl, int* out){
+    size_t o = 0, pos = 0;
+    for(size_t i = 0; i < ns; i++){
+        size_t k = gallop_lower(large, nl, pos, small[i]);
+        std::copy(large + pos, large + k, out + o);
+        o += k - pos;
+        out[o++] = small[i];
+        pos = k + (k < nl && large[k] == small[i]);
+    }
+    std::copy(large + pos, large + nl, out + o);
+    return o + nl - pos;
+}
+
+#ifdef DEDUP_X86
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,popcnt"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+#endif
+namespace sorted_set_avx2 {
+const int W = 8;
+enum set_op { intersect, count, difference };
+
+// writes the lanes of v selected by mask to out, packed, touching no memory past them
+inline size_t emit(__m256i v, unsigned mask, int* out){
+    static const dedup_avx2::compress_table table;
+    __m256i order = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(table.lanes[mask]));
+    int k = _mm_popcnt_u32(mask);
+    __m256i first_k = _mm256_cmpgt_epi32(_mm256_set1_epi32(k), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    _mm256_maskstore_epi32(out, first_k, _mm256_permutevar8x32_epi32(v, order));
+    return k;
+}
+
+template <set_op OP>
+inline size_t all_pairs(const int* a, size_t na, const int* b, size_t nb, int* out){
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    size_t i = 0, j = 0, o = 0;
+    unsigned matched = 0; // for difference: lanes of the current a block found in some b block
+    while(i + W <= na && j + W <= nb){
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+        __m256i eq = _mm256_cmpeq_epi32(va, vb);
+        for(int r = 1; r < W; r++){
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi32(va, vb));
+        }
+        unsigned m = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        int a_last = a[i + W - 1], b_last = b[j + W - 1];
+        if constexpr(OP == intersect) o += emit(va, m, out + o);
+        if constexpr(OP == count) o += _mm_popcnt_u32(m);
+        if constexpr(OP == difference) matched |= m;
+        if(a_last <= b_last){
+            if constexpr(OP == difference){
+                o += emit(va, ~matched & 0xFF, out + o);
+                matched = 0;
+            }
+            i += W;
+        }
+        if(b_last <= a_last) j += W;
+    }
+    if constexpr(OP == intersect) return o + set_intersection_scalar(a, na, b, nb, out + o, i, j);
+    if constexpr(OP == count) return o + set_intersection_count_scalar(a, na, b, nb, i, j);
+    // the a block in progress may already have lanes matched against b blocks that are behind j
+    if(matched){
+        size_t end = std::min(i + W, na);
+        for(; i < end; i++, matched >>= 1){
+            while(j < nb && b[j] < a[i]) j++;
+            if(!(matched & 1) && (j == nb || b[j] != a[i])) out[o++] = a[i];
+        }
+    }
+    return o + set_difference_scalar(a, na, b, nb, out + o, i, j);
+}
+
+// one compare-exchange stage of a bitonic merge: lanes in `upper` keep the max of the pair
+template <int UPPER>
+inline __m256i bitonic_stage(__m256i v, __m256i partner){
+    __m256i w = _mm256_permutevar8x32_epi32(v, partner);
+    return _mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), UPPER);
+}
+
+// lo and hi sorted on entry; on return lo holds the 8 smallest of the 16 and hi the 8 largest, both sorted
+inline void merge_blocks(__m256i& lo, __m256i& hi){
+    __m256i reversed = _mm256_permutevar8x32_epi32(hi, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    __m256i l = _mm256_min_epi32(lo, reversed);
+    __m256i h = _mm256_max_epi32(lo, reversed);
+    // both halves are now bitonic; three stages sort each
+    const __m256i by4 = _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3);
+    const __m256i by2 = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5);
+    const __m256i by1 = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+    l = bitonic_stage<0xF0>(l, by4), h = bitonic_stage<0xF0>(h, by4);
+    l = bitonic_stage<0xCC>(l, by2), h = bitonic_stage<0xCC>(h, by2);
+    lo = bitonic_stage<0xAA>(l, by1), hi = bitonic_stage<0xAA>(h, by1);
+}
+
+// union is a merge rather than an all-pairs compare: the 8 smallest of the block held back and the
+// next block (taken from the side whose next element is lower) are emitted, the 8 largest are held
+// back. a value in both inputs comes out twice in a row, so every lane equal to its left neighbour
+// (lane 0: the last value emitted) is dropped.
+inline size_t merge_union(const int* a, size_t na, const int* b, size_t nb, int* out){
+    if(na < W || nb < W) return set_union_scalar(a, na, b, nb, out);
+    const __m256i shift_right = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    __m256i lo = _mm256_loadu_si256((const __m256i*)a);
+    __m256i held = _mm256_loadu_si256((const __m256i*)b);
+    size_t i = W, j = W, o = 0;
+    __m256i last = _mm256_set1_epi32(0);
+    unsigned first = 1; // nothing emitted yet, so lane 0 of the first block is always kept
+    while(true){
+        merge_blocks(lo, held);
+        __m256i prev = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(lo, shift_right), last, 0x01);
+        unsigned keep = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(lo, prev))) & 0xFF;
+        o += emit(lo, keep | first, out + o);
+        first = 0;
+        last = _mm256_permutevar8x32_epi32(lo, _mm256_set1_epi32(7));
+        bool take_a = i < na && (j == nb || a[i] <= b[j]);
+        if(take_a ? i + W > na : j + W > nb) break;
+        if(take_a){
+            lo = _mm256_loadu_si256((const __m256i*)(a + i));
+            i += W;
+        } else {
+            lo = _mm256_loadu_si256((const __m256i*)(b + j));
+            j += W;
+        }
+    }
+    // three sorted sources are left: the held block and both tails. the held block may repeat a value
+    // just emitted or one still in a tail, so the scalar merge also checks against the last output
+    int rest[W];
+    _mm256_storeu_si256((__m256i*)rest, held);
+    size_t r = 0;
+    while(r < W || i < na || j < nb){
+        int x = r < W ? rest[r] : INT_MAX;
+        int y = i < na ? a[i] : INT_MAX;
+        int z = j < nb ? b[j] : INT_MAX;
+        int m = std::min(x, std::min(y, z));
+        if(r < W && x == m) r++;
+        else if(i < na && y == m) i++;
+        else j++;
+        if(o == 0 || out[o - 1] != m) out[o++] = m;
+    }
+    return o;
+}
+} // namespace sorted_set_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // DEDUP_X86
+
+inline bool sorted_set_use_avx2(){
+#ifdef DEDUP_X86
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+inline size_t set_intersection(const int* a, size_t na, const int* b, size_t nb, int* out){
+    if(set_skewed(na, nb)) return na < nb ? set_intersection_gallop(a, na, b, nb, out) : set_intersection_gallop(b, nb, a, na, out);
+#ifdef DEDUP_X86
+    if(sorted_set_use_avx2()) return sorted_set_avx2::all_pairs<sorted_set_avx2::intersect>(a, na, b, nb, out);
+#endif
+    return set_intersection_scalar(a, na, b, nb, out);
+}
+
+inline size_t set_intersection_count(const int* a, size_t na, const int* b, size_t nb){
+    if(set_skewed(na, nb)){
+        const int* small = na < nb ? a : b;
+        const int* large = na < nb ? b : a;
+        size_t ns = std::min(na, nb), nl = std::max(na, nb), count = 0, pos = 0;
+        for(size_t i = 0; i < ns && pos < nl; i++){
+            pos = gallop_lower(large, nl, pos, small[i]);
+            count += pos < nl && large[pos] == small[i];
+        }
+        return count;
+    }
+#ifdef DEDUP_X86
+    if(sorted_set_use_avx2()) return sorted_set_avx2::all_pairs<sorted_set_avx2::count>(a, na, b, nb, nullptr);
+#endif
+    return set_intersection_count_scalar(a, na, b, nb);
+}
+
+// a without the elements of b
+inline size_t set_difference(const int* a, size_t na, const int* b, size_t nb, int* out){
+    if(set_skewed(na, nb)) return set_difference_gallop(a, na, b, nb, out);
+#ifdef DEDUP_X86
+    if(sorted_set_use_avx2()) return sorted_set_avx2::all_pairs<sorted_set_avx2::difference>(a, na, b, nb, out);
+#endif
+    return set_difference_scalar(a, na, b, nb, out);
+}
+
+inline size_t set_union(const int* a, size_t na, const int* b, size_t nb, int* out){
+    if(set_skewed(na, nb)) return na < nb ? set_union_gallop(a, na, b, nb, out) : set_union_gallop(b, nb, a, na, out);
+#ifdef DEDUP_X86
+    if(sorted_set_use_avx2()) return sorted_set_avx2::merge_union(a, na, b, nb, out);
+#endif
+    return set_union_scalar(a, na, b, nb, out);
+}
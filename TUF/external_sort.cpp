@@ -0,0 +1,324 @@
+// external merge sort for binary int32 files larger than RAM.
+//
+//   g++ -O2 -std=c++17 -pthread external_sort.cpp -o external_sort
+//   ./external_sort <input> <output> [--memory-mb 1024] [--fan-in 64] [--tmp-dir .]
+//
+// pass 0 reads memory-sized chunks, sorts each one with parallel_merge_sort and writes it out as a
+// sorted run. the next chunk is read on a second thread while the current one is sorted. then runs
+// are merged fan-in at a time through a loser tree until one is left. readers use large sequential
+// blocks and ask the kernel to prefetch the following block. bytes read / written are printed per
+// pass so run length and fan-in can be sized to the disk.
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "sort.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#endif
+using namespace std;
+
+struct pass_stats {
+    int pass;
+    int runs_in;
+    int runs_out;
+    unsigned long long bytes_read;
+    unsigned long long bytes_written;
+    double seconds;
+};
+
+void print_pass(const pass_stats& s){
+    double mb = 1024.0 * 1024.0;
+    cout << "pass " << s.pass << ": " << s.runs_in << " -> " << s.runs_out << " runs, read "
+         << s.bytes_read / mb << " MB, wrote " << s.bytes_written / mb << " MB, " << s.seconds << " s ("
+         << (s.bytes_read + s.bytes_written) / mb / max(s.seconds, 1e-9) << " MB/s)" << endl;
+}
+
+// sorted runs in --tmp-dir that have not been merged away yet. the output is never listed: it may
+// be a device or a file the caller wants to look at
+vector<string> temp_runs;
+
+void run_done(const string& path){
+    temp_runs.erase(find(temp_runs.begin(), temp_runs.end(), path));
+}
+
+// a short read or write means an I/O error or a full disk: stop with an error instead of leaving a
+// truncated output that looks sorted, and take the temporary runs along
+[[noreturn]] void fail(const string& what, const string& path){
+    cerr << what << " " << path << ": " << strerror(errno) << endl;
+    for(const string& run : temp_runs) remove(run.c_str());
+    if(!temp_runs.empty()) cerr << "removed " << temp_runs.size() << " temporary run(s)" << endl;
+    exit(1);
+}
+
+// tells the kernel which byte range will be read next so it is in the page cache before we ask
+void advise_next(FILE* f, long long offset, long long length){
+#if defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fileno(f), offset, length, POSIX_FADV_WILLNEED);
+#else
+    (void)f; (void)offset; (void)length;
+#endif
+}
+
+void advise_sequential(FILE* f){
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fileno(f), 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    (void)f;
+#endif
+}
+
+// buffered reader over one sorted run
+class run_reader {
+    FILE* file;
+    string path;
+    vector<int> block;
+    size_t pos = 0;
+    size_t len = 0;
+    long long offset = 0;
+    unsigned long long& bytes_read;
+
+    void refill(){
+        len = fread(block.data(), sizeof(int), block.size(), file);
+        if(len < block.size() && ferror(file)) fail("read failed on run", path);
+        pos = 0;
+        offset += len * sizeof(int);
+        bytes_read += len * sizeof(int);
+        advise_next(file, offset, block.size() * sizeof(int));
+    }
+
+public:
+    run_reader(const string& p, size_t block_ints, unsigned long long& counter) : path(p), block(block_ints), bytes_read(counter){
+        file = fopen(path.c_str(), "rb");
+        if(!file) fail("cannot open run", path);
+        setvbuf(file, nullptr, _IONBF, 0); // the block is the buffer
+        advise_sequential(file);
+        refill();
+    }
+    ~run_reader(){ fclose(file); }
+
+    bool empty() const { return pos == len; }
+    int front() const { return block[pos]; }
+    void pop(){
+        if(++pos == len) refill();
+    }
+};
+
+class run_writer {
+    FILE* file;
+    string path;
+    vector<int> block;
+    size_t len = 0;
+    unsigned long long& bytes_written;
+
+    void put(const int* data, size_t n){
+        if(fwrite(data, sizeof(int), n, file) != n) fail("write failed on", path);
+        bytes_written += n * sizeof(int);
+    }
+
+public:
+    run_writer(const string& p, size_t block_ints, unsigned long long& counter) : path(p), block(block_ints), bytes_written(counter){
+        file = fopen(path.c_str(), "wb");
+        if(!file) fail("cannot create", path);
+        setvbuf(file, nullptr, _IONBF, 0);
+    }
+    ~run_writer(){
+        flush();
+        if(fclose(file) != 0) fail("write failed on", path);
+    }
+    void push(int x){
+        block[len++] = x;
+        if(len == block.size()) flush();
+    }
+    void write(const int* data, size_t n){
+        flush();
+        put(data, n);
+    }
+    void flush(){
+        if(len == 0) return;
+        put(block.data(), len);
+        len = 0;
+    }
+};
+
+// tournament tree over k runs. every internal node keeps the loser of the match played there and
+// tree[0] holds the overall winner, so replacing the winner replays only one leaf-to-root path:
+// log2(k) comparisons per output element instead of k.
+class loser_tree {
+    vector<run_reader*> runs;
+    vector<int> tree;
+    int k;
+
+    // an exhausted run (or a padding leaf) loses against everything
+    bool done(int r) const { return runs[r] == nullptr || runs[r]->empty(); }
+    bool beats(int a, int b) const {
+        if(done(a)) return false;
+        if(done(b)) return true;
+        return runs[a]->front() < runs[b]->front() || (runs[a]->front() == runs[b]->front() && a < b);
+    }
+
+    int build(int node){
+        if(node >= k) return node - k;
+        int left = build(2 * node);
+        int right = build(2 * node + 1);
+        if(beats(left, right)){
+            tree[node] = right;
+            return left;
+        }
+        tree[node] = left;
+        return right;
+    }
+
+public:
+    explicit loser_tree(vector<run_reader*> r) : runs(r), k(r.size()){
+        // pad to a power of two with leaves that are exhausted from the start
+        int size = 1;
+        while(size < k) size *= 2;
+        while((int)runs.size() < size) runs.push_back(nullptr);
+        k = size;
+        tree.assign(k, 0);
+        tree[0] = build(1);
+    }
+
+    bool empty() const { return done(tree[0]); }
+
+    int pop(){
+        int winner = tree[0];
+        int value = runs[winner]->front();
+        runs[winner]->pop();
+        for(int node = (winner + k) / 2; node > 0; node /= 2){
+            if(beats(tree[node], winner)) swap(tree[node], winner);
+        }
+        tree[0] = winner;
+        return value;
+    }
+};
+
+size_t read_chunk(FILE* in, vector<int>& chunk, unsigned long long& bytes_read){
+    chunk.resize(chunk.capacity());
+    size_t n = fread(chunk.data(), sizeof(int), chunk.size(), in);
+    chunk.resize(n);
+    bytes_read += n * sizeof(int);
+    return n;
+}
+
+int main(int argc, char** argv){
+    if(argc < 3){
+        cerr << "usage: " << argv[0] << " <input> <output> [--memory-mb 1024] [--fan-in 64] [--tmp-dir .]" << endl;
+        return 1;
+    }
+    string input = argv[1];
+    string output = argv[2];
+    unsigned long long memory = 1024ULL << 20;
+    int fan_in = 64;
+    string tmp_dir = ".";
+    for(int i = 3; i + 1 < argc; i += 2){
+        string flag = argv[i];
+        if(flag == "--memory-mb") memory = strtoull(argv[i + 1], nullptr, 10) << 20;
+        else if(flag == "--fan-in") fan_in = max(2, atoi(argv[i + 1]));
+        else if(flag == "--tmp-dir") tmp_dir = argv[i + 1];
+        else {
+            cerr << "unknown flag " << flag << endl;
+            return 1;
+        }
+    }
+
+    // pass 0 keeps three chunk-sized buffers alive: the chunk being sorted, its merge scratch, and the
+    // chunk being read ahead
+    size_t chunk_ints = max<size_t>(memory / 3 / sizeof(int), 1024);
+    // a merge pass splits the budget between fan_in input blocks and one output block
+    size_t block_ints = max<size_t>(memory / (fan_in + 1) / sizeof(int), 1024);
+
+    FILE* in = fopen(input.c_str(), "rb");
+    if(!in){
+        cerr << "cannot open " << input << endl;
+        return 1;
+    }
+    error_code size_error;
+    unsigned long long input_bytes = filesystem::file_size(input, size_error);
+    if(!size_error && input_bytes % sizeof(int)){
+        cerr << "warning: " << input << " ends with " << input_bytes % sizeof(int)
+             << " byte(s) that do not make a whole int; they are left out of the output" << endl;
+    }
+    setvbuf(in, nullptr, _IONBF, 0);
+    advise_sequential(in);
+
+    auto run_path = [&](int pass, int index){
+        return tmp_dir + "/run_" + to_string(pass) + "_" + to_string(index) + ".bin";
+    };
+
+    // ---- pass 0: sorted runs ----
+    vector<string> runs;
+    pass_stats stats{0, 1, 0, 0, 0, 0};
+    auto start = chrono::steady_clock::now();
+    vector<int> current, next;
+    current.reserve(chunk_ints);
+    next.reserve(chunk_ints);
+    read_chunk(in, current, stats.bytes_read);
+    if(ferror(in)) fail("read failed on", input);
+    while(!current.empty()){
+        future<size_t> ahead = async(launch::async, [&]{ return read_chunk(in, next, stats.bytes_read); });
+        parallel_merge_sort(current, 0, (int)current.size() - 1);
+        ahead.wait();
+        // checked here and not on the reading thread, which must not exit while the sort is running
+        if(ferror(in)) fail("read failed on", input);
+        runs.push_back(run_path(0, runs.size()));
+        temp_runs.push_back(runs.back());
+        {
+            run_writer out(runs.back(), 0, stats.bytes_written);
+            out.write(current.data(), current.size());
+        }
+        swap(current, next);
+    }
+    fclose(in);
+    stats.runs_out = runs.size();
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    print_pass(stats);
+
+    if(runs.empty()){
+        run_writer out(output, 1, stats.bytes_written); // empty input, empty output
+        return 0;
+    }
+    current = vector<int>();
+    next = vector<int>();
+
+    // ---- merge passes ----
+    if(runs.size() == 1 && rename(runs[0].c_str(), output.c_str()) == 0) return 0;
+    for(int pass = 1; ; pass++){
+        bool last_pass = (int)runs.size() <= fan_in;
+        pass_stats s{pass, (int)runs.size(), 0, 0, 0, 0};
+        start = chrono::steady_clock::now();
+        vector<string> merged;
+        for(size_t first = 0; first < runs.size(); first += fan_in){
+            size_t last = min(runs.size(), first + fan_in);
+            string target = last_pass ? output : run_path(pass, merged.size());
+            if(!last_pass) temp_runs.push_back(target);
+            {
+                vector<run_reader*> readers;
+                for(size_t r = first; r < last; r++) readers.push_back(new run_reader(runs[r], block_ints, s.bytes_read));
+                run_writer out(target, block_ints, s.bytes_written);
+                loser_tree tree(readers);
+                while(!tree.empty()) out.push(tree.pop());
+                for(run_reader* r : readers) delete r;
+            }
+            for(size_t r = first; r < last; r++){
+                remove(runs[r].c_str());
+                run_done(runs[r]);
+            }
+            merged.push_back(target);
+        }
+        s.runs_out = merged.size();
+        s.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        print_pass(s);
+        runs = merged;
+        if(last_pass) break;
+    }
+    return 0;
+}
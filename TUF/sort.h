@@ -0,0 +1,1405 @@
+// sorting engines shared by sort.cpp, sort_bench.cpp and the other TUF programs
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "sort_network.h"
+#include "thread_pool.h"
+using namespace std;
+
+// comparison / element move counters read by sort_bench. they cost nothing unless the program is
+// built with -DSORT_COUNTERS, so timings should come from a build without it.
+struct sort_counters {
+    atomic<unsigned long long> comparisons{0};
+    atomic<unsigned long long> moves{0};
+};
+inline sort_counters& sort_stats(){
+    static sort_counters counters;
+    return counters;
+}
+#ifdef SORT_COUNTERS
+#define SORT_COUNT_CMP(n) (sort_stats().comparisons.fetch_add((n), memory_order_relaxed))
+#define SORT_COUNT_MOVE(n) (sort_stats().moves.fetch_add((n), memory_order_relaxed))
+#else
+#define SORT_COUNT_CMP(n) ((void)0)
+#define SORT_COUNT_MOVE(n) ((void)0)
+#endif
+
+inline void selection_sort(vector<int>& arr){
+    int n = arr.size();
+    for(int i = 0 ; i < n-1 ; i++){
+        int min = i;
+        SORT_COUNT_CMP(n - i - 1);
+        for(int j = i+1;j<n;j++){
+            if(arr[j]<arr[min]){
+                min = j;
+            }
+        }
+        if (min != i) {
+            swap(arr[i], arr[min]);
+            SORT_COUNT_MOVE(3);
+        }
+    }
+}
+inline void bubble_sort(vector<int>& arr){
+    int n = arr.size();
+    for(int i = n-1 ; i>0 ; i--){
+        int sorted = 0;
+        for(int j = 0;j<i;j++){
+            SORT_COUNT_CMP(1);
+            if(arr[j]>arr[j+1]){
+                swap(arr[j],arr[j+1]);
+                SORT_COUNT_MOVE(3);
+                sorted = 1;
+            }
+        }
+        // a pass without swaps means the rest is already in order
+        if(sorted==0){
+            break;
+        }
+    }
+}
+inline void insertion_sort(vector<int>& arr, int low, int high){
+    for(int i = low + 1; i <= high; i++){
+        int key = arr[i];
+        int j = i;
+        while(j > low && arr[j-1] > key){
+            arr[j] = arr[j-1];
+            j--;
+        }
+        arr[j] = key;
+        SORT_COUNT_CMP(i - j + (j > low));
+        SORT_COUNT_MOVE(i - j + 1);
+    }
+}
+inline void insertion_sort(vector<int>& arr){
+    insertion_sort(arr, 0, (int)arr.size() - 1);
+}
+inline void merge(vector<int>& arr, int low , int mid , int high, vector<int>& temp){
+    // temp is the caller's scratch buffer (at least arr.size() long), merged run is built in temp[low..high]
+    int left = low;
+    int right = mid +1;
+    int k = low;
+    while(left <= mid && right <= high){
+        SORT_COUNT_CMP(1);
+        if(arr[left] <= arr[right]){
+            temp[k++] = arr[left++];
+        } else {
+            temp[k++] = arr[right++];
+        }
+    }
+    while(left <= mid){
+        temp[k++] = arr[left++];
+    }
+    while(right <= high){
+        temp[k++] = arr[right++];
+    }
+    for(int i = low; i <= high; i++){
+        arr[i] = temp[i];
+    }
+    SORT_COUNT_MOVE(2 * (high - low + 1));
+}
+inline void merge_sort(vector<int>& arr , int low , int high, vector<int>& temp){
+    if(low>=high) return ;
+    if(high - low < NETWORK_SORT_MAX){
+        small_sort(arr.data() + low, high - low + 1);
+        return;
+    }
+    int mid = (low + high ) / 2;
+    merge_sort(arr,low,mid,temp);
+    merge_sort(arr,mid+1,high,temp);
+    merge(arr, low, mid, high, temp);
+}
+inline void merge_sort(vector<int>& arr , int low , int  high){
+    if(low>=high) return ;
+    vector<int> temp(arr.size()); // one scratch buffer for the whole sort
+    merge_sort(arr, low, high, temp);
+}
+
+// ---- parallel merge sort ----
+// below this many elements a range is sorted on the calling thread
+const int PARALLEL_SORT_CUTOFF = 1 << 14;
+// below this many output elements a merge is done on the calling thread
+const int PARALLEL_MERGE_CUTOFF = 1 << 15;
+
+// number of elements of a[0..n) among the first k elements of the stable merge of a and b
+inline int co_rank(int k, const int* a, int n, const int* b, int m){
+    int lo = max(0, k - m);
+    int hi = min(k, n);
+    while(lo < hi){
+        int i = lo + (hi - lo) / 2;
+        if(b[k - i - 1] < a[i]){
+            hi = i;
+        } else {
+            lo = i + 1;
+        }
+    }
+    return lo;
+}
+inline void merge_runs(const int* a, int n, const int* b, int m, int* out){
+    int i = 0, j = 0, k = 0;
+    while(i < n && j < m){
+        if(a[i] <= b[j]) out[k++] = a[i++];
+        else out[k++] = b[j++];
+    }
+    SORT_COUNT_CMP(k);
+    while(i < n) out[k++] = a[i++];
+    while(j < m) out[k++] = b[j++];
+    SORT_COUNT_MOVE(k);
+}
+// splits the output into equal pieces with co_rank so every piece is merged by its own task
+inline void parallel_merge(const int* a, int n, const int* b, int m, int* out, thread_pool& pool){
+    int total = n + m;
+    if(total <= PARALLEL_MERGE_CUTOFF || pool.size() == 1){
+        merge_runs(a, n, b, m, out);
+        return;
+    }
+    int pieces = min<int>(pool.size() * 4, total / PARALLEL_MERGE_CUTOFF + 1);
+    thread_pool::task_group group(pool);
+    for(int p = 0; p < pieces; p++){
+        group.run([=]{
+            int k0 = (long long)total * p / pieces;
+            int k1 = (long long)total * (p + 1) / pieces;
+            int i0 = co_rank(k0, a, n, b, m);
+            int i1 = co_rank(k1, a, n, b, m);
+            merge_runs(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0), out + k0);
+        });
+    }
+    group.wait();
+}
+// leaf of the parallel sort: sorts arr[low..high] using the matching part of temp as scratch
+inline void sequential_merge_sort(int* arr, int* temp, int low, int high){
+    if(low>=high) return ;
+    if(high - low < NETWORK_SORT_MAX){
+        small_sort(arr + low, high - low + 1);
+        return;
+    }
+    int mid = low + (high - low) / 2;
+    sequential_merge_sort(arr, temp, low, mid);
+    sequential_merge_sort(arr, temp, mid + 1, high);
+    merge_runs(arr + low, mid - low + 1, arr + mid + 1, high - mid, temp + low);
+    copy(temp + low, temp + high + 1, arr + low);
+    SORT_COUNT_MOVE(high - low + 1);
+}
+// sorts src[low..high]; the result ends up in dst when to_dst is set, otherwise back in src.
+// the halves are sorted into the other buffer so every level is a single merge pass without copy back.
+inline void parallel_merge_sort(int* src, int* dst, int low, int high, bool to_dst, thread_pool& pool){
+    int n = high - low + 1;
+    if(n <= PARALLEL_SORT_CUTOFF){
+        sequential_merge_sort(src, dst, low, high);
+        if(to_dst){
+            copy(src + low, src + high + 1, dst + low);
+            SORT_COUNT_MOVE(n);
+        }
+        return;
+    }
+    int mid = low + (high - low) / 2;
+    thread_pool::task_group group(pool);
+    group.run([=, &pool]{ parallel_merge_sort(src, dst, low, mid, !to_dst, pool); });
+    parallel_merge_sort(src, dst, mid + 1, high, !to_dst, pool);
+    group.wait();
+    int* from = to_dst ? src : dst;
+    int* into = to_dst ? dst : src;
+    parallel_merge(from + low, mid - low + 1, from + mid + 1, high - mid, into + low, pool);
+}
+inline void parallel_merge_sort(vector<int>& arr, int low, int high, thread_pool& pool = default_pool()){
+    if(low>=high) return ;
+    vector<int> temp(arr.size()); // the only scratch allocation of the sort
+    parallel_merge_sort(arr.data(), temp.data(), low, high, false, pool);
+}
+// ---- quick sort (introsort) ----
+// the generic intro_sort (sort_generic.h) finishes ranges up to this size with insertion_sort. the int
+// intro_sort below stops at NETWORK_SORT_MAX instead and only uses this as the smallest side of a
+// lopsided split that is worth the pattern-breaking swaps
+const int INSERTION_SORT_CUTOFF = 24;
+// element moves partial_insertion_sort may make before it gives up (pdqsort's limit)
+const int PARTIAL_INSERTION_LIMIT = 8;
+// above this size the pivot is a ninther (median of three medians) instead of a median of three
+const int NINTHER_CUTOFF = 128;
+// elements classified per block by the branchless partition
+const int PARTITION_BLOCK = 64;
+
+inline void sift_down(vector<int>& arr, int low, int root, int n){
+    while(true){
+        int child = 2 * root + 1;
+        if(child >= n) return;
+        SORT_COUNT_CMP(child + 1 < n ? 2 : 1);
+        if(child + 1 < n && arr[low + child] < arr[low + child + 1]) child++;
+        if(arr[low + root] >= arr[low + child]) return;
+        swap(arr[low + root], arr[low + child]);
+        SORT_COUNT_MOVE(3);
+        root = child;
+    }
+}
+inline void heap_sort(vector<int>& arr, int low, int high){
+    int n = high - low + 1;
+    for(int i = n / 2 - 1; i >= 0; i--){
+        sift_down(arr, low, i, n);
+    }
+    for(int end = n - 1; end > 0; end--){
+        swap(arr[low], arr[low + end]);
+        SORT_COUNT_MOVE(3);
+        sift_down(arr, low, 0, end);
+    }
+}
+inline void sort3(vector<int>& arr, int a, int b, int c){
+    SORT_COUNT_CMP(3);
+    if(arr[b] < arr[a]) swap(arr[a], arr[b]);
+    if(arr[c] < arr[b]) swap(arr[b], arr[c]);
+    if(arr[b] < arr[a]) swap(arr[a], arr[b]);
+}
+// moves the pivot to arr[low] and leaves an element >= pivot further right, which stops the block
+// partition's first left-to-right scan without a bounds check. for median of 3 that is arr[high]; for
+// the ninther it is arr[mid + 1], from the last sort3 (arr[high] is only >= the first of the three
+// medians, which can be smaller than the pivot).
+inline void choose_pivot(vector<int>& arr, int low, int high){
+    int n = high - low + 1;
+    int mid = low + n / 2;
+    if(n > NINTHER_CUTOFF){
+        sort3(arr, low, mid, high);
+        sort3(arr, low + 1, mid - 1, high - 1);
+        sort3(arr, low + 2, mid + 1, high - 2);
+        sort3(arr, mid - 1, mid, mid + 1);
+        swap(arr[low], arr[mid]);
+    } else {
+        sort3(arr, mid, low, high);
+    }
+}
+// insertion sort of arr[low..high] that stops once more than PARTIAL_INSERTION_LIMIT elements have
+// moved. true if the range is sorted; false leaves it permuted but not sorted
+inline bool partial_insertion_sort(vector<int>& arr, int low, int high){
+    int moved = 0;
+    for(int i = low + 1; i <= high; i++){
+        SORT_COUNT_CMP(1);
+        if(!(arr[i] < arr[i - 1])) continue;
+        int key = arr[i];
+        int j = i;
+        do {
+            arr[j] = arr[j - 1];
+            j--;
+        } while(j > low && key < arr[j - 1]);
+        arr[j] = key;
+        SORT_COUNT_CMP(i - j - (j == low));
+        SORT_COUNT_MOVE(i - j + 1);
+        moved += i - j;
+        if(moved > PARTIAL_INSERTION_LIMIT) return false;
+    }
+    return true;
+}
+// branchless block partition around the pivot in arr[low] (BlockQuicksort).
+// offsets of misplaced elements are collected a block at a time without branching on the comparisons,
+// then swapped in pairs. returns the final pivot index; sets *already_partitioned when no swap was
+// needed, a hint that the input may already be in order.
+inline int block_partition(vector<int>& arr, int low, int high, bool* already_partitioned = nullptr){
+    int* begin = arr.data() + low;
+    int* end = arr.data() + high + 1;
+    int pivot = *begin;
+    int* first = begin;
+    int* last = end;
+
+    while(*++first < pivot);
+    if(first - 1 == begin){
+        while(first < last && !(*--last < pivot));
+    } else {
+        while(!(*--last < pivot));
+    }
+    SORT_COUNT_CMP((first - begin) + (end - last));
+    bool no_swaps = first >= last;
+    if(already_partitioned) *already_partitioned = no_swaps;
+    if(!no_swaps){
+        swap(*first, *last);
+        ++first;
+
+        unsigned char offsets_l[PARTITION_BLOCK];
+        unsigned char offsets_r[PARTITION_BLOCK];
+        int* base_l = first;
+        int* base_r = last;
+        int num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+        while(first < last){
+            int unknown = last - first;
+            int left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+            int right_split = num_r == 0 ? unknown - left_split : 0;
+
+            int count = min(left_split, PARTITION_BLOCK);
+            SORT_COUNT_CMP(count + min(right_split, PARTITION_BLOCK));
+            for(int i = 0; i < count; i++){
+                offsets_l[num_l] = i;
+                num_l += !(*first < pivot);
+                ++first;
+            }
+            count = min(right_split, PARTITION_BLOCK);
+            for(int i = 0; i < count; ){
+                offsets_r[num_r] = ++i;
+                num_r += *--last < pivot;
+            }
+
+            int num = min(num_l, num_r);
+            for(int i = 0; i < num; i++){
+                swap(base_l[offsets_l[start_l + i]], base_r[-offsets_r[start_r + i]]);
+            }
+            SORT_COUNT_MOVE(3 * num);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+            if(num_l == 0){
+                start_l = 0;
+                base_l = first;
+            }
+            if(num_r == 0){
+                start_r = 0;
+                base_r = last;
+            }
+        }
+        // one side may still hold misplaced elements, move them next to the boundary
+        SORT_COUNT_MOVE(3 * (num_l + num_r));
+        if(num_l){
+            while(num_l--) swap(base_l[offsets_l[start_l + num_l]], *--last);
+            first = last;
+        }
+        if(num_r){
+            while(num_r--) swap(base_r[-offsets_r[start_r + num_r]], *first), ++first;
+            last = first;
+        }
+    }
+    int* pivot_pos = first - 1;
+    SORT_COUNT_MOVE(2);
+    *begin = *pivot_pos;
+    *pivot_pos = pivot;
+    return pivot_pos - arr.data();
+}
+// three way split used when the pivot equals the element just left of the range: everything equal to
+// the pivot is gathered on the left and never looked at again. returns the last index of the equal block.
+inline int partition_equal(vector<int>& arr, int low, int high){
+    int pivot = arr[low];
+    int i = low;
+    int j = high + 1;
+    while(pivot < arr[--j]);
+    if(j == high){
+        while(i < j && !(pivot < arr[++i]));
+    } else {
+        while(!(pivot < arr[++i]));
+    }
+    while(i < j){
+        swap(arr[i], arr[j]);
+        SORT_COUNT_MOVE(3);
+        while(pivot < arr[--j]);
+        while(!(pivot < arr[++i]));
+    }
+    SORT_COUNT_CMP(high - low + 2);
+    SORT_COUNT_MOVE(2);
+    arr[low] = arr[j];
+    arr[j] = pivot;
+    return j;
+}
+inline int partition(vector<int>& arr,int low,int high){
+    if(high - low < 2){
+        if(high > low && arr[high] < arr[low]) swap(arr[low], arr[high]);
+        return low;
+    }
+    choose_pivot(arr, low, high);
+    return block_partition(arr, low, high);
+}
+inline void intro_sort(vector<int>& arr, int low, int high, int depth_limit, bool leftmost){
+    while(high - low + 1 > NETWORK_SORT_MAX){
+        int n = high - low + 1;
+        choose_pivot(arr, low, high);
+        // arr[low-1] is a previous pivot and so <= everything here. if it equals the new pivot the
+        // range is full of duplicates: split off the equal keys instead of recursing on them.
+        if(!leftmost && !(arr[low - 1] < arr[low])){
+            low = partition_equal(arr, low, high) + 1;
+            continue;
+        }
+        bool already_partitioned;
+        int p_index = block_partition(arr, low, high, &already_partitioned);
+        int l_size = p_index - low;
+        int r_size = high - p_index;
+        // a lopsided split costs one unit of the depth budget; when it runs out heap_sort takes over,
+        // which is what bounds the worst case at O(n log n). swapping a few elements breaks up
+        // patterns (organ pipes, sawtooth) that fooled the pivot sampling.
+        if(l_size < n / 8 || r_size < n / 8){
+            if(depth_limit-- == 0){
+                heap_sort(arr, low, high);
+                return;
+            }
+            if(l_size >= INSERTION_SORT_CUTOFF){
+                swap(arr[low], arr[low + l_size / 4]);
+                swap(arr[p_index - 1], arr[p_index - l_size / 4]);
+            }
+            if(r_size >= INSERTION_SORT_CUTOFF){
+                swap(arr[p_index + 1], arr[p_index + 1 + r_size / 4]);
+                swap(arr[high], arr[high - r_size / 4]);
+            }
+        } else if(already_partitioned && partial_insertion_sort(arr, low, p_index - 1)
+                  && partial_insertion_sort(arr, p_index + 1, high)){
+            // a balanced split that needed no swaps: the input is probably in order, and if both
+            // sides sort with a handful of moves there is nothing left to do (pdqsort)
+            return;
+        }
+        // recurse on the smaller side, loop on the larger one so the stack stays O(log n)
+        if(p_index - low < high - p_index){
+            intro_sort(arr, low, p_index - 1, depth_limit, leftmost);
+            low = p_index + 1;
+            leftmost = false;
+        } else {
+            intro_sort(arr, p_index + 1, high, depth_limit, false);
+            high = p_index - 1;
+        }
+    }
+    if(low < high) small_sort(arr.data() + low, high - low + 1);
+}
+inline void quick_sort(vector<int>& arr,int low,int high){
+    if(low>=high) return ;
+    int depth_limit = 0;
+    for(int n = high - low + 1; n > 1; n >>= 1) depth_limit++;
+    intro_sort(arr, low, high, depth_limit, true);
+}
+// ---- radix sort ----
+// LSD radix sort on 11 bit digits: 3 passes cover a 32 bit key
+const int RADIX_BITS = 11;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+const int RADIX_PASSES = 3;
+// below this size parallel_radix_sort stays on the calling thread
+const int PARALLEL_RADIX_CUTOFF = 1 << 16;
+
+// flipping the sign bit maps int order onto unsigned order, so negative keys sort first
+inline unsigned radix_key(int x){
+    return (unsigned)x ^ 0x80000000u;
+}
+inline unsigned radix_digit(int x, int pass){
+    return (radix_key(x) >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+}
+// a pass is useless when every key has the same digit in it
+inline bool radix_pass_needed(const unsigned* histogram, int n){
+    for(int d = 0; d < RADIX_BUCKETS; d++){
+        if(histogram[d] != 0) return histogram[d] != (unsigned)n;
+    }
+    return false;
+}
+inline void radix_sort(vector<int>& arr){
+    int n = arr.size();
+    if(n < 2) return;
+    // histograms of all three digits in one read of the input
+    vector<unsigned> histogram(RADIX_PASSES * RADIX_BUCKETS, 0);
+    for(int x : arr){
+        unsigned key = radix_key(x);
+        histogram[key & (RADIX_BUCKETS - 1)]++;
+        histogram[RADIX_BUCKETS + ((key >> RADIX_BITS) & (RADIX_BUCKETS - 1))]++;
+        histogram[2 * RADIX_BUCKETS + (key >> (2 * RADIX_BITS))]++;
+    }
+    vector<int> temp;
+    for(int pass = 0; pass < RADIX_PASSES; pass++){
+        unsigned* count = histogram.data() + pass * RADIX_BUCKETS;
+        if(!radix_pass_needed(count, n)) continue;
+        if(temp.empty()) temp.resize(n);
+        unsigned sum = 0;
+        for(int d = 0; d < RADIX_BUCKETS; d++){
+            unsigned c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for(int x : arr){
+            temp[count[radix_digit(x, pass)]++] = x;
+        }
+        SORT_COUNT_MOVE(n);
+        arr.swap(temp); // ping-pong, the sorted keys always live in arr after a pass
+    }
+}
+// every task histograms and scatters its own contiguous chunk; per (chunk, digit) offsets make the
+// scatter stable without any synchronisation between tasks
+inline void parallel_radix_sort(vector<int>& arr, thread_pool& pool = default_pool()){
+    int n = arr.size();
+    int chunks = pool.size();
+    if(n < PARALLEL_RADIX_CUTOFF || chunks == 1){
+        radix_sort(arr);
+        return;
+    }
+    vector<int> temp(n);
+    vector<unsigned> histogram((size_t)chunks * RADIX_BUCKETS);
+    vector<unsigned> total(RADIX_PASSES * RADIX_BUCKETS, 0);
+    auto chunk_begin = [&](int c){ return (int)((long long)n * c / chunks); };
+
+    // one parallel read for the global digit counts, used to skip constant passes
+    {
+        vector<unsigned> partial((size_t)chunks * RADIX_PASSES * RADIX_BUCKETS, 0);
+        thread_pool::task_group group(pool);
+        for(int c = 0; c < chunks; c++){
+            group.run([&, c]{
+                unsigned* h = partial.data() + (size_t)c * RADIX_PASSES * RADIX_BUCKETS;
+                for(int i = chunk_begin(c); i < chunk_begin(c + 1); i++){
+                    for(int pass = 0; pass < RADIX_PASSES; pass++){
+                        h[pass * RADIX_BUCKETS + radix_digit(arr[i], pass)]++;
+                    }
+                }
+            });
+        }
+        group.wait();
+        for(int c = 0; c < chunks; c++){
+            for(int k = 0; k < RADIX_PASSES * RADIX_BUCKETS; k++){
+                total[k] += partial[(size_t)c * RADIX_PASSES * RADIX_BUCKETS + k];
+            }
+        }
+    }
+    for(int pass = 0; pass < RADIX_PASSES; pass++){
+        if(!radix_pass_needed(total.data() + pass * RADIX_BUCKETS, n)) continue;
+        const int* from = arr.data();
+        int* into = temp.data();
+        thread_pool::task_group group(pool);
+        for(int c = 0; c < chunks; c++){
+            group.run([&, c]{
+                unsigned* h = histogram.data() + (size_t)c * RADIX_BUCKETS;
+                fill(h, h + RADIX_BUCKETS, 0);
+                for(int i = chunk_begin(c); i < chunk_begin(c + 1); i++){
+                    h[radix_digit(from[i], pass)]++;
+                }
+            });
+        }
+        group.wait();
+        // exclusive prefix sum in digit-major, chunk-minor order
+        unsigned sum = 0;
+        for(int d = 0; d < RADIX_BUCKETS; d++){
+            for(int c = 0; c < chunks; c++){
+                unsigned& h = histogram[(size_t)c * RADIX_BUCKETS + d];
+                unsigned count = h;
+                h = sum;
+                sum += count;
+            }
+        }
+        for(int c = 0; c < chunks; c++){
+            group.run([&, c]{
+                unsigned* offset = histogram.data() + (size_t)c * RADIX_BUCKETS;
+                for(int i = chunk_begin(c); i < chunk_begin(c + 1); i++){
+                    into[offset[radix_digit(from[i], pass)]++] = from[i];
+                }
+                SORT_COUNT_MOVE(chunk_begin(c + 1) - chunk_begin(c));
+            });
+        }
+        group.wait();
+        arr.swap(temp);
+    }
+}
+
+// ---- tim sort ----
+// adaptive stable merge sort: natural runs are found and merged instead of splitting at the middle,
+// so data made of a few sorted chunks is sorted in close to linear time
+const int TIM_MIN_MERGE = 32;
+// consecutive wins by one run before the merge switches to galloping
+const int TIM_MIN_GALLOP = 7;
+
+// the next galloping offset, 2 * ofs + 1, or max_ofs if that would pass it. checked before doubling
+// because signed overflow is undefined and a check on the result may be optimized away
+inline int gallop_step(int ofs, int max_ofs){
+    return ofs > (max_ofs - 1) / 2 ? max_ofs : ofs * 2 + 1;
+}
+// leftmost position in a[0..len) where key could be inserted (a[k-1] < key <= a[k]); the search
+// starts at hint and doubles its step, so it is cheap when the answer is near the hint
+inline int gallop_left(int key, const int* a, int len, int hint){
+    int last_ofs = 0, ofs = 1;
+    if(key > a[hint]){
+        int max_ofs = len - hint;
+        while(ofs < max_ofs && key > a[hint + ofs]){
+            last_ofs = ofs;
+            ofs = gallop_step(ofs, max_ofs);
+        }
+        ofs = min(ofs, max_ofs);
+        last_ofs += hint;
+        ofs += hint;
+    } else {
+        int max_ofs = hint + 1;
+        while(ofs < max_ofs && key <= a[hint - ofs]){
+            last_ofs = ofs;
+            ofs = gallop_step(ofs, max_ofs);
+        }
+        ofs = min(ofs, max_ofs);
+        int t = last_ofs;
+        last_ofs = hint - ofs;
+        ofs = hint - t;
+    }
+    SORT_COUNT_CMP(ofs - last_ofs);
+    last_ofs++;
+    while(last_ofs < ofs){
+        int m = last_ofs + (ofs - last_ofs) / 2;
+        if(key > a[m]) last_ofs = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+}
+// rightmost insertion position (a[k-1] <= key < a[k])
+inline int gallop_right(int key, const int* a, int len, int hint){
+    int last_ofs = 0, ofs = 1;
+    if(key < a[hint]){
+        int max_ofs = hint + 1;
+        while(ofs < max_ofs && key < a[hint - ofs]){
+            last_ofs = ofs;
+            ofs = gallop_step(ofs, max_ofs);
+        }
+        ofs = min(ofs, max_ofs);
+        int t = last_ofs;
+        last_ofs = hint - ofs;
+        ofs = hint - t;
+    } else {
+        int max_ofs = len - hint;
+        while(ofs < max_ofs && key >= a[hint + ofs]){
+            last_ofs = ofs;
+            ofs = gallop_step(ofs, max_ofs);
+        }
+        ofs = min(ofs, max_ofs);
+        last_ofs += hint;
+        ofs += hint;
+    }
+    SORT_COUNT_CMP(ofs - last_ofs);
+    last_ofs++;
+    while(last_ofs < ofs){
+        int m = last_ofs + (ofs - last_ofs) / 2;
+        if(key < a[m]) ofs = m;
+        else last_ofs = m + 1;
+    }
+    return ofs;
+}
+
+class tim_sorter {
+    int* a;
+    vector<int> tmp;   // scratch, grown to the smaller run of the largest merge so far
+    vector<int> run_base;
+    vector<int> run_len;
+    int min_gallop = TIM_MIN_GALLOP;
+
+    int* scratch(int n){
+        if((int)tmp.size() < n) tmp.resize(n);
+        return tmp.data();
+    }
+
+    // length of the run starting at lo; a strictly descending run is reversed in place (strictly,
+    // so equal keys never swap order)
+    int count_run_and_make_ascending(int lo, int hi){
+        int run_hi = lo + 1;
+        if(run_hi == hi) return 1;
+        if(a[run_hi++] < a[lo]){
+            while(run_hi < hi && a[run_hi] < a[run_hi - 1]) run_hi++;
+            reverse(a + lo, a + run_hi);
+        } else {
+            while(run_hi < hi && a[run_hi] >= a[run_hi - 1]) run_hi++;
+        }
+        SORT_COUNT_CMP(run_hi - lo - 1);
+        return run_hi - lo;
+    }
+
+    // a[lo..start) is sorted; extends it to a[lo..hi) with binary insertion
+    void binary_insertion_sort(int lo, int hi, int start){
+        for(; start < hi; start++){
+            int pivot = a[start];
+            int left = lo, right = start;
+            while(left < right){
+                int mid = (left + right) / 2;
+                SORT_COUNT_CMP(1);
+                if(pivot < a[mid]) right = mid;
+                else left = mid + 1;
+            }
+            memmove(a + left + 1, a + left, (start - left) * sizeof(int));
+            a[left] = pivot;
+            SORT_COUNT_MOVE(start - left + 1);
+        }
+    }
+
+    static int min_run_length(int n){
+        int r = 0;
+        while(n >= TIM_MIN_MERGE){
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    // keeps run lengths on the stack shrinking faster than fibonacci, which bounds the stack depth
+    // and keeps merges balanced
+    void merge_collapse(){
+        while(run_len.size() > 1){
+            int n = run_len.size() - 2;
+            if((n > 0 && run_len[n - 1] <= run_len[n] + run_len[n + 1]) ||
+               (n > 1 && run_len[n - 2] <= run_len[n] + run_len[n - 1])){
+                if(run_len[n - 1] < run_len[n + 1]) n--;
+            } else if(run_len[n] > run_len[n + 1]){
+                break;
+            }
+            merge_at(n);
+        }
+    }
+
+    void merge_force_collapse(){
+        while(run_len.size() > 1){
+            int n = run_len.size() - 2;
+            if(n > 0 && run_len[n - 1] < run_len[n + 1]) n--;
+            merge_at(n);
+        }
+    }
+
+    void merge_at(int i){
+        int base1 = run_base[i], len1 = run_len[i];
+        int base2 = run_base[i + 1], len2 = run_len[i + 1];
+        run_len[i] = len1 + len2;
+        run_base.erase(run_base.begin() + i + 1);
+        run_len.erase(run_len.begin() + i + 1);
+
+        // elements of run1 that are <= run2's first element are already in place
+        int k = gallop_right(a[base2], a + base1, len1, 0);
+        base1 += k;
+        len1 -= k;
+        if(len1 == 0) return;
+        // and so are elements of run2 that are >= run1's last element
+        len2 = gallop_left(a[base1 + len1 - 1], a + base2, len2, len2 - 1);
+        if(len2 == 0) return;
+        if(len1 <= len2) merge_lo(base1, len1, base2, len2);
+        else merge_hi(base1, len1, base2, len2);
+    }
+
+    // merge left to right with run1 (the smaller) in scratch
+    void merge_lo(int base1, int len1, int base2, int len2){
+        int* t = scratch(len1);
+        memcpy(t, a + base1, len1 * sizeof(int));
+        SORT_COUNT_MOVE(len1 + len2);
+        int c1 = 0, c2 = base2, dest = base1;
+        a[dest++] = a[c2++];
+        if(--len2 == 0){
+            memcpy(a + dest, t + c1, len1 * sizeof(int));
+            return;
+        }
+        if(len1 == 1){
+            memmove(a + dest, a + c2, len2 * sizeof(int));
+            a[dest + len2] = t[c1];
+            return;
+        }
+        int mg = min_gallop;
+        while(true){
+            int count1 = 0, count2 = 0;
+            // one element at a time until one run wins mg times in a row
+            bool done = false;
+            do {
+                SORT_COUNT_CMP(1);
+                if(a[c2] < t[c1]){
+                    a[dest++] = a[c2++];
+                    count2++;
+                    count1 = 0;
+                    if(--len2 == 0){ done = true; break; }
+                } else {
+                    a[dest++] = t[c1++];
+                    count1++;
+                    count2 = 0;
+                    if(--len1 == 1){ done = true; break; }
+                }
+            } while((count1 | count2) < mg);
+            if(done) break;
+            // galloping: copy whole stretches found by exponential search
+            do {
+                count1 = gallop_right(a[c2], t + c1, len1, 0);
+                if(count1 != 0){
+                    memcpy(a + dest, t + c1, count1 * sizeof(int));
+                    dest += count1;
+                    c1 += count1;
+                    len1 -= count1;
+                    if(len1 <= 1){ done = true; break; }
+                }
+                a[dest++] = a[c2++];
+                if(--len2 == 0){ done = true; break; }
+                count2 = gallop_left(t[c1], a + c2, len2, 0);
+                if(count2 != 0){
+                    memmove(a + dest, a + c2, count2 * sizeof(int));
+                    dest += count2;
+                    c2 += count2;
+                    len2 -= count2;
+                    if(len2 == 0){ done = true; break; }
+                }
+                a[dest++] = t[c1++];
+                if(--len1 == 1){ done = true; break; }
+                mg--;
+            } while(count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+            if(done) break;
+            if(mg < 0) mg = 0;
+            mg += 2; // leaving gallop mode makes it harder to re-enter
+        }
+        min_gallop = max(1, mg);
+        if(len1 == 1){
+            memmove(a + dest, a + c2, len2 * sizeof(int));
+            a[dest + len2] = t[c1];
+        } else {
+            memcpy(a + dest, t + c1, len1 * sizeof(int));
+        }
+    }
+
+    // merge right to left with run2 (the smaller) in scratch
+    void merge_hi(int base1, int len1, int base2, int len2){
+        int* t = scratch(len2);
+        memcpy(t, a + base2, len2 * sizeof(int));
+        SORT_COUNT_MOVE(len1 + len2);
+        int c1 = base1 + len1 - 1, c2 = len2 - 1, dest = base2 + len2 - 1;
+        a[dest--] = a[c1--];
+        if(--len1 == 0){
+            memcpy(a + dest - (len2 - 1), t, len2 * sizeof(int));
+            return;
+        }
+        if(len2 == 1){
+            dest -= len1;
+            c1 -= len1;
+            memmove(a + dest + 1, a + c1 + 1, len1 * sizeof(int));
+            a[dest] = t[c2];
+            return;
+        }
+        int mg = min_gallop;
+        while(true){
+            int count1 = 0, count2 = 0;
+            bool done = false;
+            do {
+                SORT_COUNT_CMP(1);
+                if(t[c2] < a[c1]){
+                    a[dest--] = a[c1--];
+                    count1++;
+                    count2 = 0;
+                    if(--len1 == 0){ done = true; break; }
+                } else {
+                    a[dest--] = t[c2--];
+                    count2++;
+                    count1 = 0;
+                    if(--len2 == 1){ done = true; break; }
+                }
+            } while((count1 | count2) < mg);
+            if(done) break;
+            do {
+                count1 = len1 - gallop_right(t[c2], a + base1, len1, len1 - 1);
+                if(count1 != 0){
+                    dest -= count1;
+                    c1 -= count1;
+                    len1 -= count1;
+                    memmove(a + dest + 1, a + c1 + 1, count1 * sizeof(int));
+                    if(len1 == 0){ done = true; break; }
+                }
+                a[dest--] = t[c2--];
+                if(--len2 == 1){ done = true; break; }
+                count2 = len2 - gallop_left(a[c1], t, len2, len2 - 1);
+                if(count2 != 0){
+                    dest -= count2;
+                    c2 -= count2;
+                    len2 -= count2;
+                    memcpy(a + dest + 1, t + c2 + 1, count2 * sizeof(int));
+                    if(len2 <= 1){ done = true; break; }
+                }
+                a[dest--] = a[c1--];
+                if(--len1 == 0){ done = true; break; }
+                mg--;
+            } while(count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+            if(done) break;
+            if(mg < 0) mg = 0;
+            mg += 2;
+        }
+        min_gallop = max(1, mg);
+        if(len2 == 1){
+            dest -= len1;
+            c1 -= len1;
+            memmove(a + dest + 1, a + c1 + 1, len1 * sizeof(int));
+            a[dest] = t[c2];
+        } else {
+            memcpy(a + dest - (len2 - 1), t, len2 * sizeof(int));
+        }
+    }
+
+public:
+    void sort(int* data, int n){
+        a = data;
+        if(n < 2) return;
+        if(n < TIM_MIN_MERGE){
+            binary_insertion_sort(0, n, count_run_and_make_ascending(0, n));
+            return;
+        }
+        int min_run = min_run_length(n);
+        int lo = 0;
+        int remaining = n;
+        do {
+            int len = count_run_and_make_ascending(lo, n);
+            // short runs are extended to min_run so merges stay balanced
+            if(len < min_run){
+                int force = min(remaining, min_run);
+                binary_insertion_sort(lo, lo + force, lo + len);
+                len = force;
+            }
+            run_base.push_back(lo);
+            run_len.push_back(len);
+            merge_collapse();
+            lo += len;
+            remaining -= len;
+        } while(remaining != 0);
+        merge_force_collapse();
+    }
+};
+
+inline void tim_sort(vector<int>& arr){
+    tim_sorter sorter;
+    sorter.sort(arr.data(), arr.size());
+}
+
+// ---- parallel sample sort ----
+// below this size parallel_sample_sort just runs quick_sort
+const int SAMPLE_SORT_CUTOFF = 1 << 17;
+// up to 2^8 = 256 ranges between splitters, each with an extra bucket for keys equal to its splitter
+const int SAMPLE_LOG_BUCKETS = 8;
+// sample size per bucket; more samples give more even buckets
+const int SAMPLE_OVERSAMPLING = 16;
+// elements each task buffers per bucket before writing them out as one block
+const int SAMPLE_BLOCK = 16;
+
+// splitters stored as an implicit binary search tree (children of node i at 2i and 2i+1), so
+// classifying a key is log2(buckets) steps of compare-and-shift with no branches
+struct sample_classifier {
+    int log_buckets;
+    int buckets;
+    vector<int> tree;      // tree[1..buckets)
+    vector<int> splitters; // sorted, buckets - 1 of them
+
+    void build(int node, int lo, int hi){
+        if(node >= buckets) return;
+        int mid = (lo + hi) / 2;
+        tree[node] = splitters[mid];
+        build(2 * node, lo, mid);
+        build(2 * node + 1, mid + 1, hi);
+    }
+
+    sample_classifier(vector<int> sorted_splitters, int log_b) : log_buckets(log_b), buckets(1 << log_b), tree(1 << log_b), splitters(sorted_splitters){
+        build(1, 0, buckets - 1);
+    }
+
+    // bucket 2b holds splitters[b-1] < x < splitters[b], bucket 2b+1 holds x == splitters[b]
+    int classify(int x) const {
+        int b = 1;
+        for(int l = 0; l < log_buckets; l++) b = 2 * b + (tree[b] < x);
+        b -= buckets;
+        return 2 * b + (b < buckets - 1 && x == splitters[b]);
+    }
+};
+
+inline void parallel_sample_sort(vector<int>& arr, thread_pool& pool){
+    int n = arr.size();
+    int tasks = pool.size();
+    if(n < SAMPLE_SORT_CUTOFF || tasks == 1){
+        if(n > 1) quick_sort(arr, 0, n - 1);
+        return;
+    }
+
+    // oversampled splitters, deterministic so runs are reproducible
+    int buckets = 1 << SAMPLE_LOG_BUCKETS;
+    vector<int> sample(buckets * SAMPLE_OVERSAMPLING);
+    unsigned long long state = 0x9E3779B97F4A7C15ULL ^ n;
+    for(int& x : sample){
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        x = arr[state % n];
+    }
+    quick_sort(sample, 0, sample.size() - 1);
+    vector<int> splitters(buckets - 1);
+    for(int i = 0; i < buckets - 1; i++) splitters[i] = sample[(i + 1) * SAMPLE_OVERSAMPLING - 1];
+    sample_classifier classifier(splitters, SAMPLE_LOG_BUCKETS);
+    int total_buckets = 2 * buckets;
+
+    // pass 1: every task counts its chunk per bucket
+    auto chunk_begin = [&](int t){ return (int)((long long)n * t / tasks); };
+    vector<int> offsets((size_t)tasks * total_buckets, 0);
+    thread_pool::task_group group(pool);
+    for(int t = 0; t < tasks; t++){
+        group.run([&, t]{
+            int* count = offsets.data() + (size_t)t * total_buckets;
+            for(int i = chunk_begin(t); i < chunk_begin(t + 1); i++) count[classifier.classify(arr[i])]++;
+        });
+    }
+    group.wait();
+    // bucket-major prefix sum gives every (task, bucket) pair its own output range
+    vector<int> bucket_start(total_buckets + 1);
+    int sum = 0;
+    for(int b = 0; b < total_buckets; b++){
+        bucket_start[b] = sum;
+        for(int t = 0; t < tasks; t++){
+            int& c = offsets[(size_t)t * total_buckets + b];
+            int count = c;
+            c = sum;
+            sum += count;
+        }
+    }
+    bucket_start[total_buckets] = n;
+
+    // pass 2: scatter through small per-bucket buffers so the writes go out as whole blocks
+    vector<int> temp(n);
+    for(int t = 0; t < tasks; t++){
+        group.run([&, t]{
+            int* pos = offsets.data() + (size_t)t * total_buckets;
+            vector<int> buffer((size_t)total_buckets * SAMPLE_BLOCK);
+            vector<int> fill_count(total_buckets, 0);
+            for(int i = chunk_begin(t); i < chunk_begin(t + 1); i++){
+                int x = arr[i];
+                int b = classifier.classify(x);
+                int* block = buffer.data() + (size_t)b * SAMPLE_BLOCK;
+                block[fill_count[b]++] = x;
+                if(fill_count[b] == SAMPLE_BLOCK){
+                    memcpy(temp.data() + pos[b], block, SAMPLE_BLOCK * sizeof(int));
+                    pos[b] += SAMPLE_BLOCK;
+                    fill_count[b] = 0;
+                }
+            }
+            for(int b = 0; b < total_buckets; b++){
+                memcpy(temp.data() + pos[b], buffer.data() + (size_t)b * SAMPLE_BLOCK, fill_count[b] * sizeof(int));
+            }
+            SORT_COUNT_MOVE(chunk_begin(t + 1) - chunk_begin(t));
+        });
+    }
+    group.wait();
+    arr.swap(temp);
+
+    // pass 3: buckets are independent; equality buckets are already sorted
+    for(int b = 0; b < total_buckets; b += 2){
+        int lo = bucket_start[b], hi = bucket_start[b + 1] - 1;
+        if(hi > lo) group.run([&arr, lo, hi]{ quick_sort(arr, lo, hi); });
+    }
+    group.wait();
+}
+// threads = 0 uses the shared default pool, anything else a pool of exactly that size
+inline void parallel_sample_sort(vector<int>& arr, unsigned threads = 0){
+    if(threads == 0){
+        parallel_sample_sort(arr, default_pool());
+        return;
+    }
+    if(threads == 1 || (int)arr.size() < SAMPLE_SORT_CUTOFF){
+        if(arr.size() > 1) quick_sort(arr, 0, arr.size() - 1);
+        return;
+    }
+    thread_pool pool(threads);
+    parallel_sample_sort(arr, pool);
+}
+
+// ---- selection (nth element / top k) ----
+inline int deterministic_select(vector<int>& arr, int low, int high, int k);
+
+// splits arr[low..high] into < pivot, == pivot, > pivot and returns the bounds of the middle block
+inline pair<int, int> partition3(vector<int>& arr, int low, int high, int pivot){
+    int lt = low, i = low, gt = high;
+    while(i <= gt){
+        SORT_COUNT_CMP(2);
+        if(arr[i] < pivot) swap(arr[lt++], arr[i++]);
+        else if(pivot < arr[i]) swap(arr[i], arr[gt--]);
+        else i++;
+    }
+    return {lt, gt};
+}
+// median of groups of five, gathered at the front, then the median of those found recursively.
+// guarantees at least 30% of the range on each side of the pivot.
+inline int median_of_medians(vector<int>& arr, int low, int high){
+    int m = 0;
+    for(int i = low; i <= high; i += 5){
+        int end = min(i + 4, high);
+        insertion_sort(arr, i, end);
+        swap(arr[low + m], arr[i + (end - i) / 2]);
+        m++;
+    }
+    return deterministic_select(arr, low, low + m - 1, low + (m - 1) / 2);
+}
+// worst case linear selection, the fallback once introselect keeps picking bad pivots
+inline int deterministic_select(vector<int>& arr, int low, int high, int k){
+    while(high - low + 1 > 5){
+        auto [lt, gt] = partition3(arr, low, high, median_of_medians(arr, low, high));
+        if(k < lt) high = lt - 1;
+        else if(k > gt) low = gt + 1;
+        else return arr[k];
+    }
+    insertion_sort(arr, low, high);
+    return arr[k];
+}
+// introselect: quick_sort's partitioning, but only the side holding k is followed. afterwards arr[k]
+// is the element a full sort would put there, everything before it is <= and everything after >=.
+// requires low <= k <= high.
+inline int select_kth(vector<int>& arr, int low, int high, int k){
+    assert(0 <= low && low <= k && k <= high && high < (int)arr.size());
+    int depth_limit = 0;
+    for(int n = high - low + 1; n > 1; n >>= 1) depth_limit++;
+    bool leftmost = true;
+    while(high - low + 1 > NETWORK_SORT_MAX){
+        int n = high - low + 1;
+        choose_pivot(arr, low, high);
+        // same duplicate check as intro_sort; the equal block is already in its final place
+        if(!leftmost && !(arr[low - 1] < arr[low])){
+            int equal_end = partition_equal(arr, low, high);
+            if(k <= equal_end) return arr[k];
+            low = equal_end + 1;
+            continue;
+        }
+        bool already_partitioned;
+        int p_index = block_partition(arr, low, high, &already_partitioned);
+        if(p_index == k) return arr[k];
+        int l_size = p_index - low;
+        int r_size = high - p_index;
+        if(l_size < n / 8 || r_size < n / 8){
+            if(depth_limit-- == 0) return deterministic_select(arr, low, high, k);
+            if(l_size >= INSERTION_SORT_CUTOFF){
+                swap(arr[low], arr[low + l_size / 4]);
+                swap(arr[p_index - 1], arr[p_index - l_size / 4]);
+            }
+            if(r_size >= INSERTION_SORT_CUTOFF){
+                swap(arr[p_index + 1], arr[p_index + 1 + r_size / 4]);
+                swap(arr[high], arr[high - r_size / 4]);
+            }
+        } else if(already_partitioned && (k < p_index ? partial_insertion_sort(arr, low, p_index - 1)
+                                                      : partial_insertion_sort(arr, p_index + 1, high))){
+            // as in intro_sort, but only the side holding k has to come out sorted
+            return arr[k];
+        }
+        if(k < p_index){
+            high = p_index - 1;
+        } else {
+            low = p_index + 1;
+            leftmost = false;
+        }
+    }
+    if(low < high) small_sort(arr.data() + low, high - low + 1);
+    return arr[k];
+}
+// k-th smallest (0 based) in O(n), e.g. select_kth(arr, arr.size() / 2) for the median.
+// requires 0 <= k < arr.size(), so arr must not be empty
+inline int select_kth(vector<int>& arr, int k){
+    assert(0 <= k && k < (int)arr.size());
+    return select_kth(arr, 0, arr.size() - 1, k);
+}
+// the k smallest elements, sorted, in arr[0..k); the rest is left in no particular order. O(n + k log k)
+inline void partial_sort_k(vector<int>& arr, int k){
+    int n = arr.size();
+    k = min(k, n);
+    if(k <= 0) return;
+    if(k < n) select_kth(arr, 0, n - 1, k - 1);
+    quick_sort(arr, 0, k - 1);
+}
+// the k largest elements in descending order. arr is reordered but keeps its contents
+inline vector<int> top_k(vector<int>& arr, int k){
+    int n = arr.size();
+    k = min(k, n);
+    if(k <= 0) return {};
+    if(k < n) select_kth(arr, 0, n - 1, n - k);
+    quick_sort(arr, n - k, n - 1);
+    return vector<int>(arr.rbegin(), arr.rbegin() + k);
+}
+
+// top k over a stream that never has to be in memory at once: a min-heap of the k largest seen so
+// far, whose root is the bar a new value has to clear. O(n log k) time and O(k) memory.
+class top_k_stream {
+    int k;
+    vector<int> heap;
+
+public:
+    explicit top_k_stream(int k) : k(max(k, 0)) { heap.reserve(this->k); }
+
+    void push(int x){
+        if((int)heap.size() < k){
+            heap.push_back(x);
+            push_heap(heap.begin(), heap.end(), greater<int>());
+        } else if(k > 0 && heap.front() < x){
+            pop_heap(heap.begin(), heap.end(), greater<int>());
+            heap.back() = x;
+            push_heap(heap.begin(), heap.end(), greater<int>());
+        }
+    }
+    void push(const int* data, size_t n){
+        for(size_t i = 0; i < n; i++) push(data[i]);
+    }
+
+    int size() const { return heap.size(); }
+    // smallest value still in the top k; only meaningful once size() > 0
+    int threshold() const { return heap.front(); }
+
+    // the k largest so far, descending
+    vector<int> result() const {
+        vector<int> out = heap;
+        sort_heap(out.begin(), out.end(), greater<int>());
+        return out;
+    }
+};
+
+// ---- counting sort ----
+// arr holds only values in [low_value, high_value]; O(n + range) time and memory, one count per value
+inline void counting_sort(vector<int>& arr, int low_value, int high_value){
+    vector<int> count((long long)high_value - low_value + 1, 0);
+    for(int x : arr) count[(long long)x - low_value]++;
+    int* out = arr.data();
+    for(size_t v = 0; v < count.size(); v++){
+        out = fill_n(out, count[v], (int)(low_value + (long long)v));
+    }
+    SORT_COUNT_MOVE(arr.size());
+}
+// a range of n or more values would cost more counters than elements (up to 2^32 for INT_MIN..INT_MAX),
+// so wide inputs go to quick_sort instead
+inline void counting_sort(vector<int>& arr){
+    if(arr.size() < 2) return;
+    auto [lo, hi] = minmax_element(arr.begin(), arr.end());
+    if((long long)*hi - *lo >= (long long)arr.size()){
+        quick_sort(arr, 0, arr.size() - 1);
+        return;
+    }
+    counting_sort(arr, *lo, *hi);
+}
+// ---- adaptive dispatch ----
+// elements sampled for the inversion and duplicate estimates
+const int AUTO_SAMPLE = 256;
+// below this quick_sort wins against radix_sort's fixed cost per pass
+const int AUTO_RADIX_CUTOFF = 1 << 13;
+// few enough runs for tim_sort: at most one per this many elements
+const int AUTO_RUN_RATIO = 16;
+// below this share of out of order sample pairs the input is mostly in order, which quick_sort's
+// pivot sampling handles better than radix_sort
+const double AUTO_FEW_INVERSIONS = 0.05;
+// at most 8 distinct values in the sample: quick_sort's equal-key partitioning then beats radix_sort's
+// fixed passes. at 2^22 elements, 2.7 against 6.2 ns per element with 4 values, 3.8 against 6.2 with 8;
+// with 16 radix_sort is ahead again
+const double AUTO_MANY_DUPLICATES = 1.0 - 8.0 / AUTO_SAMPLE;
+
+// what the probe measured and which engine sort_auto picked, for checking the choice afterwards
+struct sort_auto_stats {
+    int n = 0;
+    int runs = 0;                // ascending or descending runs, as tim_sort would find them (full pass)
+    long long range = 0;         // max - min (full pass)
+    int sampled = 0;             // elements in the sample, 0 when n is too small to bother
+    double inversion_ratio = 0;  // out of order pairs / all pairs, in the sample
+    double duplicate_ratio = 0;  // 1 - distinct / sampled
+    const char* engine = "";
+    const char* reason = "";
+};
+
+// one pass counts runs and range, a small evenly spaced sample estimates disorder and duplicates,
+// then the input goes to the engine that does best on that shape in sort_bench
+inline void sort_auto(vector<int>& arr, sort_auto_stats* stats = nullptr){
+    sort_auto_stats st;
+    int n = arr.size();
+    st.n = n;
+    auto decide = [&](const char* engine, const char* reason){
+        st.engine = engine;
+        st.reason = reason;
+        if(stats) *stats = st;
+    };
+    if(n < 2) return decide("none", "fewer than two elements");
+
+    // runs are split the way tim_sort finds them: a run ends at a step against its direction and the
+    // next one takes its direction from its first unequal step, so equal neighbours never end a run
+    // (tim_sort ends a descending run at them, which this ignores). no branches, so random input costs
+    // no mispredicts
+    int lo = arr[0], hi = arr[0];
+    int descents = 0, ascents = 0, breaks = 0;
+    int up = 0, down = 0; // direction of the current run, neither until its first unequal step
+    for(int i = 0; i + 1 < n; i++){
+        int x = arr[i], next = arr[i + 1];
+        int rise = next > x, fall = next < x;
+        descents += fall;
+        ascents += rise;
+        int ends = (rise & down) | (fall & up);
+        breaks += ends;
+        up = (up | rise) & ~fall & ~ends;
+        down = (down | fall) & ~rise & ~ends;
+        lo = min(lo, next);
+        hi = max(hi, next);
+    }
+    SORT_COUNT_CMP(4 * (n - 1));
+    st.runs = breaks + 1;
+    st.range = (long long)hi - lo;
+
+    if(descents == 0) return decide("none", "already sorted");
+    if(ascents == 0){
+        reverse(arr.begin(), arr.end());
+        return decide("reverse", "non-increasing");
+    }
+    if(n <= NETWORK_SORT_MAX){
+        small_sort(arr.data(), n);
+        return decide("small_sort", "fits one sorting network");
+    }
+    if(st.range < n){
+        counting_sort(arr, lo, hi);
+        return decide("counting_sort", "value range smaller than n");
+    }
+
+    if(n >= AUTO_RADIX_CUTOFF){
+        int sample[AUTO_SAMPLE];
+        for(int i = 0; i < AUTO_SAMPLE; i++) sample[i] = arr[(long long)n * i / AUTO_SAMPLE];
+        long long inversions = 0;
+        for(int i = 0; i < AUTO_SAMPLE; i++){
+            for(int j = i + 1; j < AUTO_SAMPLE; j++) inversions += sample[j] < sample[i];
+        }
+        small_sort_scalar(sample, AUTO_SAMPLE);
+        int distinct = 1;
+        for(int i = 1; i < AUTO_SAMPLE; i++) distinct += sample[i] != sample[i - 1];
+        st.sampled = AUTO_SAMPLE;
+        st.inversion_ratio = (double)inversions / (AUTO_SAMPLE * (AUTO_SAMPLE - 1) / 2);
+        st.duplicate_ratio = 1.0 - (double)distinct / AUTO_SAMPLE;
+    }
+    if(st.runs <= n / AUTO_RUN_RATIO){
+        tim_sort(arr);
+        return decide("tim_sort", "few long runs");
+    }
+    // duplicates over a narrow range went to counting_sort above. over a wide range a handful of
+    // distinct values goes to quick_sort, which sets each equal block aside after one pass
+    if(st.sampled && st.inversion_ratio < AUTO_FEW_INVERSIONS){
+        quick_sort(arr, 0, n - 1);
+        return decide("quick_sort", "mostly in order but in short runs");
+    }
+    if(n >= AUTO_RADIX_CUTOFF){
+        if(n >= PARALLEL_RADIX_CUTOFF && default_pool().size() > 1){
+            parallel_radix_sort(arr);
+            return decide("parallel_radix_sort", "large, no exploitable order");
+        }
+        if(st.duplicate_ratio >= AUTO_MANY_DUPLICATES){
+            quick_sort(arr, 0, n - 1);
+            return decide("quick_sort", "few distinct values over a wide range");
+        }
+        radix_sort(arr);
+        return decide("radix_sort", "no exploitable order");
+    }
+    quick_sort(arr, 0, n - 1);
+    decide("quick_sort", "small, no exploitable order");
+}
+
+// ---- choosing an engine ----
+enum class sort_mode {
+    selection,
+    bubble,
+    insertion,
+    merge,
+    parallel_merge,
+    quick,
+    tim,
+    parallel_sample,
+    radix,
+    parallel_radix,
+    adaptive,
+};
+inline const char* sort_mode_name(sort_mode mode){
+    switch(mode){
+        case sort_mode::selection: return "selection_sort";
+        case sort_mode::bubble: return "bubble_sort";
+        case sort_mode::insertion: return "insertion_sort";
+        case sort_mode::merge: return "merge_sort";
+        case sort_mode::parallel_merge: return "parallel_merge_sort";
+        case sort_mode::quick: return "quick_sort";
+        case sort_mode::tim: return "tim_sort";
+        case sort_mode::parallel_sample: return "parallel_sample_sort";
+        case sort_mode::radix: return "radix_sort";
+        case sort_mode::parallel_radix: return "parallel_radix_sort";
+        case sort_mode::adaptive: return "sort_auto";
+    }
+    return "unknown";
+}
+inline void sort_with(vector<int>& arr, sort_mode mode){
+    int high = (int)arr.size() - 1;
+    switch(mode){
+        case sort_mode::selection: selection_sort(arr); break;
+        case sort_mode::bubble: bubble_sort(arr); break;
+        case sort_mode::insertion: insertion_sort(arr); break;
+        case sort_mode::merge: merge_sort(arr, 0, high); break;
+        case sort_mode::parallel_merge: parallel_merge_sort(arr, 0, high); break;
+        case sort_mode::quick: quick_sort(arr, 0, high); break;
+        case sort_mode::tim: tim_sort(arr); break;
+        case sort_mode::parallel_sample: parallel_sample_sort(arr); break;
+        case sort_mode::radix: radix_sort(arr); break;
+        case sort_mode::parallel_radix: parallel_radix_sort(arr); break;
+        case sort_mode::adaptive: sort_auto(arr); break;
+    }
+}
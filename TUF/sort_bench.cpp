@@ -0,0 +1,289 @@
+// benchmark for the sorts in sort.h over several input distributions and sizes.
+//
+//   g++ -O2 -std=c++17 -pthread sort_bench.cpp -o sort_bench                    timings
+//   g++ -O2 -std=c++17 -pthread -DSORT_COUNTERS sort_bench.cpp -o sort_count    + comparisons / moves
+//
+//   ./sort_bench [--min-n 16] [--max-n 100000000] [--quadratic-max 32768] [--reps 3]
+//                [--algos quick_sort,radix_sort] [--dists random,sorted] [--csv out.csv] [--json out.json]
+//
+// every run is checked for sortedness. allocations are counted by replacing operator new, and on linux
+// cache and branch misses come from perf_event_open (reported as -1 when the kernel refuses).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "sort.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// ---- allocation counting ----
+// gcc flags the malloc/free pair below as mismatched even though both operators are replaced together
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static atomic<unsigned long long> allocation_count{0};
+static atomic<unsigned long long> allocation_bytes{0};
+
+void* operator new(size_t size){
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    allocation_bytes.fetch_add(size, memory_order_relaxed);
+    if(void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ---- hardware counters ----
+enum class hw_event { cache_misses, branch_misses };
+
+struct hw_counter {
+    int fd = -1;
+
+    explicit hw_counter(hw_event event){
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = event == hw_event::cache_misses ? PERF_COUNT_HW_CACHE_MISSES : PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1; // include the pool threads, which are started after the counters are opened
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+        (void)event;
+#endif
+    }
+    ~hw_counter(){
+#ifdef __linux__
+        if(fd >= 0) close(fd);
+#endif
+    }
+    void start(){
+#ifdef __linux__
+        if(fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop(){
+#ifdef __linux__
+        if(fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long value = 0;
+        if(read(fd, &value, sizeof(value)) != sizeof(value)) return -1;
+        return value;
+#else
+        return -1;
+#endif
+    }
+};
+
+// ---- input distributions ----
+const char* DISTRIBUTIONS[] = {"random", "sorted", "reverse", "few_unique", "organ_pipe", "nearly_sorted", "sawtooth",
+                             "random_pairs", "few_wide_pairs"};
+
+vector<int> make_input(const string& dist, int n, mt19937& rng){
+    vector<int> arr(n);
+    if(dist == "random"){
+        for(int& x : arr) x = rng();
+    } else if(dist == "sorted"){
+        for(int i = 0; i < n; i++) arr[i] = i;
+    } else if(dist == "reverse"){
+        for(int i = 0; i < n; i++) arr[i] = n - i;
+    } else if(dist == "few_unique"){
+        for(int& x : arr) x = rng() % 16;
+    } else if(dist == "organ_pipe"){
+        for(int i = 0; i < n; i++) arr[i] = i < n / 2 ? i : n - i;
+    } else if(dist == "nearly_sorted"){
+        // sorted with 1% of the positions swapped at random
+        for(int i = 0; i < n; i++) arr[i] = i;
+        for(int k = 0; k < n / 100 + 1; k++) swap(arr[rng() % n], arr[rng() % n]);
+    } else if(dist == "sawtooth"){
+        // 32 ascending teeth
+        int tooth = n / 32 + 1;
+        for(int i = 0; i < n; i++) arr[i] = i % tooth;
+    } else if(dist == "random_pairs"){
+        // every value twice in a row: the plateaus must not hide the run breaks from sort_auto
+        for(int i = 0; i < n; i++) arr[i] = i % 2 ? arr[i - 1] : (int)rng();
+    } else if(dist == "few_wide_pairs"){
+        // the same with 8 distinct values spread over the whole int range
+        int values[8];
+        for(int& v : values) v = rng();
+        for(int i = 0; i < n; i++) arr[i] = i % 2 ? arr[i - 1] : values[rng() % 8];
+    }
+    return arr;
+}
+
+const int SIZES[] = {16, 128, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// ---- results ----
+struct bench_result {
+    string algo;
+    string dist;
+    int n;
+    double ns_per_element;
+    unsigned long long comparisons;
+    unsigned long long moves;
+    unsigned long long allocations;
+    unsigned long long allocated_bytes;
+    long long cache_misses;
+    long long branch_misses;
+};
+
+vector<string> split_list(const string& s){
+    vector<string> out;
+    size_t start = 0;
+    while(start <= s.size()){
+        size_t comma = s.find(',', start);
+        if(comma == string::npos) comma = s.size();
+        if(comma > start) out.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return out;
+}
+
+bool selected(const vector<string>& filter, const string& name){
+    if(filter.empty()) return true;
+    for(const string& f : filter){
+        if(f == name) return true;
+    }
+    return false;
+}
+
+void write_csv(const string& path, const vector<bench_result>& results){
+    FILE* f = fopen(path.c_str(), "w");
+    if(!f){
+        cerr << "cannot write " << path << endl;
+        return;
+    }
+    fprintf(f, "algo,dist,n,ns_per_element,comparisons,moves,allocations,allocated_bytes,cache_misses,branch_misses\n");
+    for(const bench_result& r : results){
+        fprintf(f, "%s,%s,%d,%.3f,%llu,%llu,%llu,%llu,%lld,%lld\n", r.algo.c_str(), r.dist.c_str(), r.n,
+                r.ns_per_element, r.comparisons, r.moves, r.allocations, r.allocated_bytes, r.cache_misses, r.branch_misses);
+    }
+    fclose(f);
+}
+
+void write_json(const string& path, const vector<bench_result>& results){
+    FILE* f = fopen(path.c_str(), "w");
+    if(!f){
+        cerr << "cannot write " << path << endl;
+        return;
+    }
+    fprintf(f, "[\n");
+    for(size_t i = 0; i < results.size(); i++){
+        const bench_result& r = results[i];
+        fprintf(f, "  {\"algo\": \"%s\", \"dist\": \"%s\", \"n\": %d, \"ns_per_element\": %.3f, \"comparisons\": %llu, "
+                   "\"moves\": %llu, \"allocations\": %llu, \"allocated_bytes\": %llu, \"cache_misses\": %lld, \"branch_misses\": %lld}%s\n",
+                r.algo.c_str(), r.dist.c_str(), r.n, r.ns_per_element, r.comparisons, r.moves, r.allocations,
+                r.allocated_bytes, r.cache_misses, r.branch_misses, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "]\n");
+    fclose(f);
+}
+
+int main(int argc, char** argv){
+    long long min_n = 16, max_n = 100000000, quadratic_max = 1 << 15;
+    int reps = 3;
+    vector<string> algo_filter, dist_filter;
+    string csv_path, json_path;
+    for(int i = 1; i + 1 < argc; i += 2){
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if(flag == "--min-n") min_n = atoll(value.c_str());
+        else if(flag == "--max-n") max_n = atoll(value.c_str());
+        else if(flag == "--quadratic-max") quadratic_max = atoll(value.c_str());
+        else if(flag == "--reps") reps = max(1, atoi(value.c_str()));
+        else if(flag == "--algos") algo_filter = split_list(value);
+        else if(flag == "--dists") dist_filter = split_list(value);
+        else if(flag == "--csv") csv_path = value;
+        else if(flag == "--json") json_path = value;
+        else {
+            cerr << "unknown flag " << flag << endl;
+            return 1;
+        }
+    }
+
+    // opened before the pool exists so its workers inherit the counters
+    hw_counter cache_misses(hw_event::cache_misses);
+    hw_counter branch_misses(hw_event::branch_misses);
+    default_pool();
+
+    vector<int> sizes;
+    for(int n : SIZES){
+        if(n >= min_n && n <= max_n) sizes.push_back(n);
+    }
+    const sort_mode modes[] = {sort_mode::selection, sort_mode::bubble, sort_mode::insertion, sort_mode::merge,
+                               sort_mode::parallel_merge, sort_mode::quick, sort_mode::tim,
+                               sort_mode::parallel_sample, sort_mode::radix, sort_mode::parallel_radix,
+                               sort_mode::adaptive};
+
+    vector<bench_result> results;
+    mt19937 rng(12345);
+    printf("%-20s %-14s %10s %10s %14s %14s %8s %12s %12s\n", "algo", "dist", "n", "ns/elem", "comparisons",
+           "moves", "allocs", "cache_miss", "branch_miss");
+    for(const char* dist : DISTRIBUTIONS){
+        if(!selected(dist_filter, dist)) continue;
+        for(int n : sizes){
+            vector<int> input = make_input(dist, n, rng);
+            for(sort_mode mode : modes){
+                bool quadratic = mode == sort_mode::selection || mode == sort_mode::bubble || mode == sort_mode::insertion;
+                if(quadratic && n > quadratic_max) continue;
+                if(!selected(algo_filter, sort_mode_name(mode))) continue;
+
+                bench_result r{sort_mode_name(mode), dist, n, 0, 0, 0, 0, 0, -1, -1};
+                double best = 1e300;
+                sort_auto_stats choice;
+                for(int rep = 0; rep < reps; rep++){
+                    vector<int> arr = input;
+                    sort_stats().comparisons = 0;
+                    sort_stats().moves = 0;
+                    unsigned long long allocs_before = allocation_count, bytes_before = allocation_bytes;
+                    cache_misses.start();
+                    branch_misses.start();
+                    auto start = chrono::steady_clock::now();
+                    if(mode == sort_mode::adaptive) sort_auto(arr, &choice);
+                    else sort_with(arr, mode);
+                    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+                    long long cm = cache_misses.stop();
+                    long long bm = branch_misses.stop();
+                    if(!is_sorted(arr.begin(), arr.end())){
+                        cerr << sort_mode_name(mode) << " did not sort " << dist << " n=" << n << endl;
+                        return 1;
+                    }
+                    if(ns < best){
+                        best = ns;
+                        r.ns_per_element = ns / n;
+                        r.comparisons = sort_stats().comparisons;
+                        r.moves = sort_stats().moves;
+                        r.allocations = allocation_count - allocs_before;
+                        r.allocated_bytes = allocation_bytes - bytes_before;
+                        r.cache_misses = cm;
+                        r.branch_misses = bm;
+                    }
+                }
+                // sort_auto is reported with the engine it picked, so its choices can be checked against the rest
+                if(mode == sort_mode::adaptive) r.algo = string("sort_auto:") + choice.engine;
+                printf("%-20s %-14s %10d %10.2f %14llu %14llu %8llu %12lld %12lld\n", r.algo.c_str(), dist, n,
+                       r.ns_per_element, r.comparisons, r.moves, r.allocations, r.cache_misses, r.branch_misses);
+                fflush(stdout);
+                results.push_back(r);
+            }
+        }
+    }
+    if(!csv_path.empty()) write_csv(csv_path, results);
+    if(!json_path.empty()) write_json(json_path, results);
+    return 0;
+}
@@ -0,0 +1,345 @@
+// iterator + comparator + projection versions of the sorts in sort.h, for sorting records in place.
+//
+//   struct order { int id; double price; };
+//   quick_sort(orders.begin(), orders.end(), less<>(), &order::price);
+//   merge_sort(orders.begin(), orders.end(), greater<>(), [](const order& o){ return o.id; });
+//
+// comparator and projection are template parameters, so every call is inlined. trivially copyable
+// records are shifted with memmove, and std::less / std::less<> on an arithmetic key switches the
+// merge and the partition to branch-free code at compile time.
+#pragma once
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "sort.h"
+
+struct sort_identity {
+    template <class T>
+    T&& operator()(T&& x) const { return std::forward<T>(x); }
+};
+
+template <class Iter>
+using sort_iter_value_t = typename std::iterator_traits<Iter>::value_type;
+
+template <class Iter, class Proj>
+using projected_key_t = std::decay_t<std::invoke_result_t<Proj&, sort_iter_value_t<Iter>&>>;
+
+// memmove needs real addresses: raw pointers and vector iterators qualify
+template <class Iter>
+constexpr bool is_contiguous_iter = std::is_pointer<Iter>::value ||
+    std::is_same<Iter, typename std::vector<sort_iter_value_t<Iter>>::iterator>::value ||
+    std::is_same<Iter, typename std::vector<sort_iter_value_t<Iter>>::const_iterator>::value;
+
+template <class Iter>
+constexpr bool can_memmove = is_contiguous_iter<Iter> && std::is_trivially_copyable<sort_iter_value_t<Iter>>::value;
+
+template <class Comp, class Key>
+constexpr bool is_plain_less = std::is_same<Comp, std::less<>>::value || std::is_same<Comp, std::less<Key>>::value;
+
+// comparisons on these keys compile to a flag-setting instruction, so they can feed arithmetic
+template <class Iter, class Comp, class Proj>
+constexpr bool branchless_keys = std::is_arithmetic<projected_key_t<Iter, Proj>>::value &&
+    is_plain_less<Comp, projected_key_t<Iter, Proj>>;
+
+template <class Comp, class Proj>
+struct projected_less {
+    Comp& comp;
+    Proj& proj;
+    template <class A, class B>
+    bool operator()(A& a, B& b) const { return comp(std::invoke(proj, a), std::invoke(proj, b)); }
+};
+
+template <class Iter>
+auto* address_of(Iter it){
+    return &*it;
+}
+
+// ---- insertion sort ----
+template <class Iter, class Comp = std::less<>, class Proj = sort_identity>
+void insertion_sort(Iter first, Iter last, Comp comp = {}, Proj proj = {}){
+    using T = sort_iter_value_t<Iter>;
+    projected_less<Comp, Proj> before{comp, proj};
+    if(last - first < 2) return;
+    for(Iter i = first + 1; i != last; ++i){
+        if(!before(*i, *(i - 1))) continue;
+        T key = std::move(*i);
+        Iter j = i - 1;
+        while(j != first && before(key, *(j - 1))) --j;
+        // [j, i) moves up one slot
+        if constexpr(can_memmove<Iter>){
+            std::memmove(address_of(j) + 1, address_of(j), (i - j) * sizeof(T));
+        } else {
+            std::move_backward(j, i, i + 1);
+        }
+        *j = std::move(key);
+    }
+}
+
+// ---- merge sort ----
+// merges [first, mid) and [mid, last); the left run is parked in buffer first, so the output never
+// overtakes the unread part of the right run
+template <class Iter, class T, class Comp, class Proj>
+void merge_with_buffer(Iter first, Iter mid, Iter last, T* buffer, Comp& comp, Proj& proj){
+    projected_less<Comp, Proj> before{comp, proj};
+    std::ptrdiff_t left_size = mid - first;
+    if constexpr(can_memmove<Iter>){
+        std::memcpy(buffer, address_of(first), left_size * sizeof(T));
+    } else {
+        std::move(first, mid, buffer);
+    }
+    T* l = buffer;
+    T* l_end = buffer + left_size;
+    Iter r = mid;
+    Iter out = first;
+    if constexpr(branchless_keys<Iter, Comp, Proj> && can_memmove<Iter>){
+        // the comparison result picks the source and advances one side without a branch
+        T* base = address_of(first);
+        T* rp = base + left_size;
+        T* r_end = base + (last - first);
+        T* o = base;
+        while(l != l_end && rp != r_end){
+            bool take_right = before(*rp, *l);
+            *o++ = *(take_right ? rp : l);
+            rp += take_right;
+            l += !take_right;
+        }
+        out = first + (o - base);
+    } else {
+        while(l != l_end && r != last){
+            if(before(*r, *l)){
+                *out = std::move(*r);
+                ++r;
+            } else {
+                *out = std::move(*l);
+                ++l;
+            }
+            ++out;
+        }
+    }
+    // whatever is left of the right run is already in place
+    if constexpr(can_memmove<Iter>){
+        std::memcpy(address_of(first) + (out - first), l, (l_end - l) * sizeof(T));
+    } else {
+        std::move(l, l_end, out);
+    }
+}
+
+template <class Iter, class T, class Comp, class Proj>
+void merge_sort_with_buffer(Iter first, Iter last, T* buffer, Comp& comp, Proj& proj){
+    if(last - first <= 32){
+        insertion_sort(first, last, comp, proj);
+        return;
+    }
+    Iter mid = first + (last - first) / 2;
+    merge_sort_with_buffer(first, mid, buffer, comp, proj);
+    merge_sort_with_buffer(mid, last, buffer, comp, proj);
+    projected_less<Comp, Proj> before{comp, proj};
+    if(!before(*mid, *(mid - 1))) return; // halves already in order
+    merge_with_buffer(first, mid, last, buffer, comp, proj);
+}
+
+// stable; allocates one buffer of half the range. the buffer holds constructed records that the
+// merge move-assigns into, so the record type must be default constructible
+template <class Iter, class Comp = std::less<>, class Proj = sort_identity>
+void merge_sort(Iter first, Iter last, Comp comp = {}, Proj proj = {}){
+    using T = sort_iter_value_t<Iter>;
+    static_assert(std::is_default_constructible<T>::value, "merge_sort needs a default constructible record type");
+    if(last - first < 2) return;
+    std::vector<T> buffer((last - first + 1) / 2);
+    merge_sort_with_buffer(first, last, buffer.data(), comp, proj);
+}
+
+// ---- quick sort ----
+template <class Iter, class Comp, class Proj>
+void sift_down(Iter first, std::ptrdiff_t root, std::ptrdiff_t n, Comp& comp, Proj& proj){
+    projected_less<Comp, Proj> before{comp, proj};
+    while(true){
+        std::ptrdiff_t child = 2 * root + 1;
+        if(child >= n) return;
+        if(child + 1 < n && before(first[child], first[child + 1])) child++;
+        if(!before(first[root], first[child])) return;
+        std::iter_swap(first + root, first + child);
+        root = child;
+    }
+}
+
+template <class Iter, class Comp = std::less<>, class Proj = sort_identity>
+void heap_sort(Iter first, Iter last, Comp comp = {}, Proj proj = {}){
+    std::ptrdiff_t n = last - first;
+    for(std::ptrdiff_t i = n / 2 - 1; i >= 0; i--) sift_down(first, i, n, comp, proj);
+    for(std::ptrdiff_t end = n - 1; end > 0; end--){
+        std::iter_swap(first, first + end);
+        sift_down(first, 0, end, comp, proj);
+    }
+}
+
+template <class Iter, class Before>
+void sort3(Iter a, Iter b, Iter c, Before& before){
+    if(before(*b, *a)) std::iter_swap(a, b);
+    if(before(*c, *b)) std::iter_swap(b, c);
+    if(before(*b, *a)) std::iter_swap(a, b);
+}
+
+// same contract as the vector<int> block_partition in sort.h: pivot in *first and an element not
+// less than it somewhere to its right, which stops the first left-to-right scan. intro_sort's median
+// of 3 leaves it in *(last - 1), the ninther in *(mid + 1). branch-free classification when the keys
+// allow it.
+template <class Iter, class Comp, class Proj>
+Iter partition_pivot_first(Iter first, Iter last, Comp& comp, Proj& proj){
+    using T = sort_iter_value_t<Iter>;
+    projected_less<Comp, Proj> before{comp, proj};
+    T pivot = std::move(*first);
+    Iter begin = first;
+    Iter l = first;
+    Iter r = last;
+    while(before(*++l, pivot));
+    if(l - 1 == begin){
+        while(l < r && !before(*--r, pivot));
+    } else {
+        while(!before(*--r, pivot));
+    }
+    if(l < r){
+        if constexpr(branchless_keys<Iter, Comp, Proj>){
+            std::iter_swap(l, r);
+            ++l;
+            auto key = std::invoke(proj, pivot);
+            unsigned char offsets_l[PARTITION_BLOCK];
+            unsigned char offsets_r[PARTITION_BLOCK];
+            Iter base_l = l;
+            Iter base_r = r;
+            int num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            while(l < r){
+                std::ptrdiff_t unknown = r - l;
+                std::ptrdiff_t left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                std::ptrdiff_t right_split = num_r == 0 ? unknown - left_split : 0;
+                int count = std::min<std::ptrdiff_t>(left_split, PARTITION_BLOCK);
+                for(int i = 0; i < count; i++){
+                    offsets_l[num_l] = i;
+                    num_l += !(std::invoke(proj, *l) < key);
+                    ++l;
+                }
+                count = std::min<std::ptrdiff_t>(right_split, PARTITION_BLOCK);
+                for(int i = 0; i < count; ){
+                    offsets_r[num_r] = ++i;
+                    num_r += std::invoke(proj, *--r) < key;
+                }
+                int num = std::min(num_l, num_r);
+                for(int i = 0; i < num; i++){
+                    std::iter_swap(base_l + offsets_l[start_l + i], base_r - offsets_r[start_r + i]);
+                }
+                num_l -= num;
+                num_r -= num;
+                start_l += num;
+                start_r += num;
+                if(num_l == 0){
+                    start_l = 0;
+                    base_l = l;
+                }
+                if(num_r == 0){
+                    start_r = 0;
+                    base_r = r;
+                }
+            }
+            if(num_l){
+                while(num_l--) std::iter_swap(base_l + offsets_l[start_l + num_l], --r);
+                l = r;
+            }
+            if(num_r){
+                while(num_r--) std::iter_swap(base_r - offsets_r[start_r + num_r], l), ++l;
+            }
+        } else {
+            while(l < r){
+                std::iter_swap(l, r);
+                while(before(*++l, pivot));
+                while(!before(*--r, pivot));
+            }
+        }
+    }
+    Iter pivot_pos = l - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return pivot_pos;
+}
+
+// puts everything equivalent to the pivot in *first at the front, returns the last of them
+template <class Iter, class Comp, class Proj>
+Iter partition_equal(Iter first, Iter last, Comp& comp, Proj& proj){
+    using T = sort_iter_value_t<Iter>;
+    projected_less<Comp, Proj> before{comp, proj};
+    T pivot = std::move(*first);
+    Iter l = first;
+    Iter r = last;
+    while(before(pivot, *--r));
+    if(r + 1 == last){
+        while(l < r && !before(pivot, *++l));
+    } else {
+        while(!before(pivot, *++l));
+    }
+    while(l < r){
+        std::iter_swap(l, r);
+        while(before(pivot, *--r));
+        while(!before(pivot, *++l));
+    }
+    *first = std::move(*r);
+    *r = std::move(pivot);
+    return r;
+}
+
+template <class Iter, class Comp, class Proj>
+void intro_sort(Iter first, Iter last, int depth_limit, bool leftmost, Comp& comp, Proj& proj){
+    projected_less<Comp, Proj> before{comp, proj};
+    while(last - first > INSERTION_SORT_CUTOFF){
+        std::ptrdiff_t n = last - first;
+        Iter mid = first + n / 2;
+        if(n > NINTHER_CUTOFF){
+            sort3(first, mid, last - 1, before);
+            sort3(first + 1, mid - 1, last - 2, before);
+            sort3(first + 2, mid + 1, last - 3, before);
+            sort3(mid - 1, mid, mid + 1, before);
+            std::iter_swap(first, mid);
+        } else {
+            sort3(mid, first, last - 1, before);
+        }
+        if(!leftmost && !before(*(first - 1), *first)){
+            first = partition_equal(first, last, comp, proj) + 1;
+            continue;
+        }
+        Iter pivot = partition_pivot_first(first, last, comp, proj);
+        std::ptrdiff_t l_size = pivot - first;
+        std::ptrdiff_t r_size = last - pivot - 1;
+        if(l_size < n / 8 || r_size < n / 8){
+            if(depth_limit-- == 0){
+                heap_sort(first, last, comp, proj);
+                return;
+            }
+            if(l_size >= INSERTION_SORT_CUTOFF){
+                std::iter_swap(first, first + l_size / 4);
+                std::iter_swap(pivot - 1, pivot - l_size / 4);
+            }
+            if(r_size >= INSERTION_SORT_CUTOFF){
+                std::iter_swap(pivot + 1, pivot + 1 + r_size / 4);
+                std::iter_swap(last - 1, last - 1 - r_size / 4);
+            }
+        }
+        if(l_size < r_size){
+            intro_sort(first, pivot, depth_limit, leftmost, comp, proj);
+            first = pivot + 1;
+            leftmost = false;
+        } else {
+            intro_sort(pivot + 1, last, depth_limit, false, comp, proj);
+            last = pivot;
+        }
+    }
+    insertion_sort(first, last, comp, proj);
+}
+
+// not stable; O(n log n) worst case like the vector<int> quick_sort
+template <class Iter, class Comp = std::less<>, class Proj = sort_identity>
+void quick_sort(Iter first, Iter last, Comp comp = {}, Proj proj = {}){
+    int depth_limit = 0;
+    for(std::ptrdiff_t n = last - first; n > 1; n >>= 1) depth_limit++;
+    intro_sort(first, last, depth_limit, true, comp, proj);
+}
@@ -0,0 +1,232 @@
+// in-register bitonic sorting networks for up to 64 ints, used as the leaf case of quick_sort and
+// merge_sort. the AVX2 kernel holds 8 ints per register, the SSE4.1 one 4; the best one the cpu
+// supports is picked once at run time and everything else falls back to insertion sort.
+//
+// the network is the all-ascending bitonic sort: to merge two sorted blocks of size k, compare
+// element i with its mirror 2k-1-i, then run half cleaners at distance k/2, k/4, ..., 1. distances
+// of a register width or more are plain min/max between whole registers; smaller ones shuffle lanes
+// inside a register and blend the min and max halves back together.
+#pragma once
+#include <climits>
+#include <cstring>
+
+const int NETWORK_SORT_MAX = 64;
+
+inline void small_sort_scalar(int* a, int n){
+    for(int i = 1; i < n; i++){
+        int key = a[i];
+        int j = i;
+        while(j > 0 && a[j-1] > key){
+            a[j] = a[j-1];
+            j--;
+        }
+        a[j] = key;
+    }
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SORT_NETWORK_X86 1
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace network_avx2 {
+const int W = 8;
+typedef __m256i vec;
+
+template <int UPPER_LANES>
+inline vec exchange(vec v, vec partner){
+    return _mm256_blend_epi32(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner), UPPER_LANES);
+}
+inline vec reverse(vec v){
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+// compare lane i with lane 2k-1-i of its 2k block
+template <int K>
+inline vec mirror(vec v){
+    if constexpr(K == 1) return exchange<0xAA>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6)));
+    else if constexpr(K == 2) return exchange<0xCC>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(3, 2, 1, 0, 7, 6, 5, 4)));
+    else return exchange<0xF0>(v, reverse(v));
+}
+// compare lane i with lane i ^ j
+template <int J>
+inline vec half_clean(vec v){
+    if constexpr(J == 1) return exchange<0xAA>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6)));
+    else if constexpr(J == 2) return exchange<0xCC>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5)));
+    else return exchange<0xF0>(v, _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3)));
+}
+inline void min_max(vec& a, vec& b){
+    vec lo = _mm256_min_epi32(a, b);
+    b = _mm256_max_epi32(a, b);
+    a = lo;
+}
+inline void mirror_pair(vec& a, vec& b){
+    vec rb = reverse(b);
+    vec lo = _mm256_min_epi32(a, rb);
+    b = reverse(_mm256_max_epi32(a, rb));
+    a = lo;
+}
+
+// half cleaners at distance J, J/2, ..., 1 over R registers
+template <int R, int J>
+inline void half_cleaners(vec* v){
+    if constexpr(J >= W){
+        for(int b = 0; b < R; b += 2 * (J / W))
+            for(int i = 0; i < J / W; i++) min_max(v[b + i], v[b + i + J / W]);
+    } else {
+        for(int r = 0; r < R; r++) v[r] = half_clean<J>(v[r]);
+    }
+    if constexpr(J > 1) half_cleaners<R, J / 2>(v);
+}
+// merges sorted blocks of K into blocks of 2K, then doubles K until all R * W lanes are one block
+template <int R, int K>
+inline void merge_stages(vec* v){
+    if constexpr(K < W){
+        for(int r = 0; r < R; r++) v[r] = mirror<K>(v[r]);
+    } else {
+        for(int b = 0; b < R; b += 2 * (K / W))
+            for(int i = 0; i < K / W; i++) mirror_pair(v[b + i], v[b + 2 * (K / W) - 1 - i]);
+    }
+    if constexpr(K > 1) half_cleaners<R, K / 2>(v);
+    if constexpr(2 * K < R * W) merge_stages<R, 2 * K>(v);
+}
+template <int R>
+inline void sort_padded(int* buf){
+    vec v[R];
+    for(int r = 0; r < R; r++) v[r] = _mm256_load_si256((const vec*)(buf + r * W));
+    merge_stages<R, 1>(v);
+    for(int r = 0; r < R; r++) _mm256_store_si256((vec*)(buf + r * W), v[r]);
+}
+
+inline void small_sort(int* a, int n){
+    alignas(32) int buf[NETWORK_SORT_MAX];
+    int padded = n <= 8 ? 8 : n <= 16 ? 16 : n <= 32 ? 32 : 64;
+    memcpy(buf, a, n * sizeof(int));
+    for(int i = n; i < padded; i++) buf[i] = INT_MAX; // padding sorts to the end
+    switch(padded){
+        case 8: sort_padded<1>(buf); break;
+        case 16: sort_padded<2>(buf); break;
+        case 32: sort_padded<4>(buf); break;
+        default: sort_padded<8>(buf); break;
+    }
+    memcpy(a, buf, n * sizeof(int));
+}
+} // namespace network_avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+namespace network_sse4 {
+const int W = 4;
+typedef __m128i vec;
+
+// UPPER_LANES is a 16 bit lane mask for _mm_blend_epi16: 0xCC = int lanes 1 and 3, 0xF0 = 2 and 3
+template <int UPPER_LANES>
+inline vec exchange(vec v, vec partner){
+    return _mm_blend_epi16(_mm_min_epi32(v, partner), _mm_max_epi32(v, partner), UPPER_LANES);
+}
+inline vec reverse(vec v){
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+template <int K>
+inline vec mirror(vec v){
+    if constexpr(K == 1) return exchange<0xCC>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    else return exchange<0xF0>(v, reverse(v));
+}
+template <int J>
+inline vec half_clean(vec v){
+    if constexpr(J == 1) return exchange<0xCC>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    else return exchange<0xF0>(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+inline void min_max(vec& a, vec& b){
+    vec lo = _mm_min_epi32(a, b);
+    b = _mm_max_epi32(a, b);
+    a = lo;
+}
+inline void mirror_pair(vec& a, vec& b){
+    vec rb = reverse(b);
+    vec lo = _mm_min_epi32(a, rb);
+    b = reverse(_mm_max_epi32(a, rb));
+    a = lo;
+}
+
+// half cleaners at distance J, J/2, ..., 1 over R registers
+template <int R, int J>
+inline void half_cleaners(vec* v){
+    if constexpr(J >= W){
+        for(int b = 0; b < R; b += 2 * (J / W))
+            for(int i = 0; i < J / W; i++) min_max(v[b + i], v[b + i + J / W]);
+    } else {
+        for(int r = 0; r < R; r++) v[r] = half_clean<J>(v[r]);
+    }
+    if constexpr(J > 1) half_cleaners<R, J / 2>(v);
+}
+// merges sorted blocks of K into blocks of 2K, then doubles K until all R * W lanes are one block
+template <int R, int K>
+inline void merge_stages(vec* v){
+    if constexpr(K < W){
+        for(int r = 0; r < R; r++) v[r] = mirror<K>(v[r]);
+    } else {
+        for(int b = 0; b < R; b += 2 * (K / W))
+            for(int i = 0; i < K / W; i++) mirror_pair(v[b + i], v[b + 2 * (K / W) - 1 - i]);
+    }
+    if constexpr(K > 1) half_cleaners<R, K / 2>(v);
+    if constexpr(2 * K < R * W) merge_stages<R, 2 * K>(v);
+}
+template <int R>
+inline void sort_padded(int* buf){
+    vec v[R];
+    for(int r = 0; r < R; r++) v[r] = _mm_load_si128((const vec*)(buf + r * W));
+    merge_stages<R, 1>(v);
+    for(int r = 0; r < R; r++) _mm_store_si128((vec*)(buf + r * W), v[r]);
+}
+
+inline void small_sort(int* a, int n){
+    alignas(16) int buf[NETWORK_SORT_MAX];
+    int padded = n <= 8 ? 8 : n <= 16 ? 16 : n <= 32 ? 32 : 64;
+    memcpy(buf, a, n * sizeof(int));
+    for(int i = n; i < padded; i++) buf[i] = INT_MAX;
+    switch(padded){
+        case 8: sort_padded<2>(buf); break;
+        case 16: sort_padded<4>(buf); break;
+        case 32: sort_padded<8>(buf); break;
+        default: sort_padded<16>(buf); break;
+    }
+    memcpy(a, buf, n * sizeof(int));
+}
+} // namespace network_sse4
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif // x86
+
+typedef void (*small_sort_fn)(int*, int);
+
+inline small_sort_fn pick_small_sort(){
+#ifdef SORT_NETWORK_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return network_avx2::small_sort;
+    if(__builtin_cpu_supports("sse4.1")) return network_sse4::small_sort;
+#endif
+    return small_sort_scalar;
+}
+
+// sorts a[0..n) for n <= NETWORK_SORT_MAX
+inline void small_sort(int* a, int n){
+    static const small_sort_fn kernel = pick_small_sort();
+    kernel(a, n);
+}
@@ -0,0 +1,187 @@
+// small work-stealing thread pool used by the parallel sorts and array scans
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class thread_pool {
+    struct worker_queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+        std::deque<std::function<void()>> pinned; // submit_to: run by this worker only, never stolen
+        std::atomic<int> pinned_count{0};
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> queues; // one deque per worker, owner pops back, thieves pop front
+    std::vector<std::thread> workers;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<int> queued{0}; // tasks any thread may take, pinned ones excluded
+    std::atomic<bool> stopping{false};
+    std::atomic<unsigned> next_queue{0};
+
+    static int& current_index() {
+        static thread_local int index = -1; // worker index of the calling thread, -1 outside the pool
+        return index;
+    }
+
+    bool pop_task(int self, std::function<void()>& task) {
+        int n = queues.size();
+        if (self >= 0) {
+            worker_queue& own = *queues[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.pinned.empty()) {
+                task = std::move(own.pinned.front());
+                own.pinned.pop_front();
+                own.pinned_count--;
+                return true;
+            }
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        int start = self >= 0 ? self + 1 : 0;
+        for (int k = 0; k < n; k++) {
+            worker_queue& victim = *queues[(start + k) % n];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(int self) {
+        current_index() = self;
+        worker_queue& own = *queues[self];
+        std::function<void()> task;
+        while (true) {
+            if (pop_task(self, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleep_lock);
+            wake.wait(guard, [&] { return stopping || queued > 0 || own.pinned_count > 0; });
+            if (stopping && queued == 0 && own.pinned_count == 0) return;
+        }
+    }
+
+    void push_to(int index, std::function<void()> task) {
+        {
+            worker_queue& q = *queues[index];
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.tasks.push_back(std::move(task));
+            queued++;
+        }
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        wake.notify_one();
+    }
+
+    void pin_to(int index, std::function<void()> task) {
+        {
+            worker_queue& q = *queues[index];
+            std::lock_guard<std::mutex> guard(q.lock);
+            q.pinned.push_back(std::move(task));
+            q.pinned_count++;
+        }
+        // notify_one could wake a worker that cannot take the task while its owner sleeps on
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        wake.notify_all();
+    }
+
+public:
+    explicit thread_pool(unsigned threads = std::thread::hardware_concurrency()) {
+        if (threads == 0) threads = 1;
+        for (unsigned i = 0; i < threads; i++) queues.emplace_back(new worker_queue());
+        for (unsigned i = 0; i < threads; i++) workers.emplace_back([this, i] { worker_loop(i); });
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    unsigned size() const { return workers.size(); }
+
+    // tasks spawned from a worker go to its own deque (LIFO for the owner), others are spread round robin
+    void submit(std::function<void()> task) {
+        int self = current_index();
+        int index = self >= 0 ? self : next_queue++ % queues.size();
+        push_to(index, std::move(task));
+    }
+
+    // run a task on a fixed worker, used when chunk -> worker placement matters (first touch pages).
+    // it is not stolen and not run by task_group::wait on another thread, so it waits for that
+    // worker to finish what it is doing
+    void submit_to(unsigned worker, std::function<void()> task) {
+        pin_to(worker % queues.size(), std::move(task));
+    }
+
+    // run one queued task on the calling thread, returns false if nothing was available. a worker
+    // also takes the tasks pinned to it; nobody takes another worker's
+    bool run_pending_task() {
+        std::function<void()> task;
+        if (!pop_task(current_index(), task)) return false;
+        task();
+        return true;
+    }
+
+    // fork-join helper: run() forks, wait() joins and executes queued work instead of blocking
+    class task_group {
+        thread_pool& pool;
+        std::atomic<int> pending{0};
+
+    public:
+        explicit task_group(thread_pool& p) : pool(p) {}
+        ~task_group() { wait(); }
+
+        template <class F>
+        void run(F f) {
+            pending++;
+            pool.submit([this, f]() mutable {
+                f();
+                pending--;
+            });
+        }
+
+        template <class F>
+        void run_on(unsigned worker, F f) {
+            pending++;
+            pool.submit_to(worker, [this, f]() mutable {
+                f();
+                pending--;
+            });
+        }
+
+        void wait() {
+            while (pending > 0) {
+                if (!pool.run_pending_task()) std::this_thread::yield();
+            }
+        }
+    };
+};
+
+// process wide pool sized to the machine, created on first use
+inline thread_pool& default_pool() {
+    static thread_pool pool;
+    return pool;
+}